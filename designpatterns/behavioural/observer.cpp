@@ -29,6 +29,20 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <atomic>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <random>
 
 // Observer Interface
 class Observer {
@@ -46,24 +60,743 @@ public:
 };
 
 
+// Asynchronous delivery
+// With a NotificationPool, notify() only posts the message to each observer's bounded
+// mailbox and returns; pool workers call update() later. A slow observer then falls
+// behind on its own instead of stalling the publisher and everyone after it. Messages
+// are published once as shared immutable buffers, so posting copies a pointer.
+using NewsMessage = std::shared_ptr<const std::string>;
+
+// What a full mailbox does with a new message
+enum class OverloadPolicy {
+    DropOldest, // Discard the oldest undelivered message
+    Block,      // Make the publisher wait for room
+    Coalesce    // Replace the newest undelivered message; the observer only needs the latest
+};
+
+struct DeliveryOptions {
+    std::size_t capacity = 64;
+    OverloadPolicy overload = OverloadPolicy::DropOldest;
+};
+
+// How far an asynchronous observer is behind
+struct ObserverLag {
+    std::size_t pending = 0; // Posted, not yet delivered
+    std::uint64_t delivered = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t coalesced = 0;
+    std::chrono::nanoseconds lastLatency{0}; // From publish to the end of update(), last delivery
+};
+
+class ObserverMailbox {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Delivery {
+        NewsMessage message;
+        Clock::time_point published;
+    };
+
+    Observer* observer;
+    DeliveryOptions options;
+    std::mutex mutex;
+    std::condition_variable room; // Blocked publishers
+    std::condition_variable idle; // detach() and flush()
+    std::deque<Delivery> queue;
+    bool scheduled = false;       // Queued on the pool or being drained
+    bool delivering = false;
+    bool closed = false;
+    std::thread::id deliverer;
+    ObserverLag stats;
+
+public:
+    ObserverMailbox(Observer* observer, DeliveryOptions options) : observer(observer), options(options) {
+        if (options.capacity == 0) {
+            throw std::invalid_argument("Mailbox capacity must be at least 1");
+        }
+    }
+
+    Observer* owner() const {
+        return observer;
+    }
+
+    // Returns true if the caller must schedule the mailbox on the pool
+    bool post(const NewsMessage& message, Clock::time_point published) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!closed && queue.size() >= options.capacity) {
+            switch (options.overload) {
+            case OverloadPolicy::DropOldest:
+                queue.pop_front();
+                ++stats.dropped;
+                break;
+            case OverloadPolicy::Coalesce:
+                queue.back().message = message; // Keeps the older publish time, so lag stays honest
+                ++stats.coalesced;
+                return false;
+            case OverloadPolicy::Block:
+                room.wait(lock, [this] { return closed || queue.size() < options.capacity; });
+                break;
+            }
+        }
+        if (closed) {
+            return false;
+        }
+        queue.push_back(Delivery{message, published});
+        if (scheduled) {
+            return false;
+        }
+        scheduled = true;
+        return true;
+    }
+
+    // Delivers up to `limit` messages on the calling worker. Returns true if more are
+    // waiting, in which case the mailbox stays scheduled and must be queued again.
+    bool drain(std::size_t limit) {
+        for (std::size_t i = 0; i < limit; ++i) {
+            Delivery next;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (queue.empty() || closed) {
+                    scheduled = false;
+                    idle.notify_all();
+                    return false;
+                }
+                next = std::move(queue.front());
+                queue.pop_front();
+                delivering = true;
+                deliverer = std::this_thread::get_id();
+            }
+            room.notify_one();
+            observer->update(*next.message);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                delivering = false;
+                ++stats.delivered;
+                stats.lastLatency = Clock::now() - next.published;
+            }
+            idle.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduled = !queue.empty() && !closed;
+        return scheduled;
+    }
+
+    // Drops undelivered messages and waits out an update() in progress, unless it is
+    // the caller's own (an observer detaching itself from inside update())
+    void close() {
+        std::unique_lock<std::mutex> lock(mutex);
+        closed = true;
+        queue.clear();
+        room.notify_all();
+        idle.wait(lock, [this] { return !delivering || deliverer == std::this_thread::get_id(); });
+    }
+
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return (queue.empty() || closed) && !delivering; });
+    }
+
+    ObserverLag lag() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ObserverLag snapshot = stats;
+        snapshot.pending = queue.size();
+        return snapshot;
+    }
+};
+
+// Worker threads that drain scheduled mailboxes. A mailbox is drained by one worker at
+// a time, so each observer sees its messages in order and never concurrently.
+class NotificationPool {
+private:
+    static constexpr std::size_t kBatch = 16; // Messages per turn, so busy observers share workers
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<ObserverMailbox>> runnable;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work() {
+        while (true) {
+            std::shared_ptr<ObserverMailbox> mailbox;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !runnable.empty(); });
+                if (stopping) {
+                    return;
+                }
+                mailbox = std::move(runnable.front());
+                runnable.pop_front();
+            }
+            if (mailbox->drain(kBatch)) {
+                schedule(std::move(mailbox));
+            }
+        }
+    }
+
+public:
+    explicit NotificationPool(std::size_t threads) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    NotificationPool(const NotificationPool&) = delete;
+    NotificationPool& operator=(const NotificationPool&) = delete;
+
+    // Undelivered messages are abandoned; flush the subjects first to deliver them
+    ~NotificationPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void schedule(std::shared_ptr<ObserverMailbox> mailbox) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runnable.push_back(std::move(mailbox));
+        }
+        ready.notify_one();
+    }
+};
+
+// Time the publisher spends in notify(). Every notify is counted, but only a sample
+// of them is timed: total and worst cover the timed ones.
+struct PublisherStats {
+    std::uint64_t notifications = 0;
+    std::uint64_t timed = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds worst{0};
+
+    std::chrono::nanoseconds average() const {
+        return timed ? total / static_cast<std::int64_t>(timed) : std::chrono::nanoseconds{0};
+    }
+};
+
+// Deferred reclamation for lock-free readers, epoch based. A reader announces the
+// global epoch for as long as it reads; a writer that unpublishes an object tags it
+// with the epoch it advances from, and frees it once every active reader announced a
+// later epoch. Read sections nest, so update() may notify again.
+// There is one domain per process, shared by every NewsAgency: a synchronize() waits
+// out readers of all agencies, not only its own. Read sections only last as long as a
+// notification, but a slow synchronous observer anywhere delays every synchronize().
+class EpochDomain {
+private:
+    static constexpr std::size_t kMaxThreads = 256;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{0}; // 0: not reading
+        std::atomic<bool> claimed{false};
+    };
+
+    struct ThreadState {
+        Slot* slot = nullptr;
+        unsigned depth = 0;
+
+        ~ThreadState() {
+            if (slot) {
+                slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<std::uint64_t> globalEpoch{1};
+    Slot slots[kMaxThreads];
+
+    EpochDomain() = default;
+
+    static ThreadState& state() {
+        thread_local ThreadState mine;
+        return mine;
+    }
+
+    Slot* claim() {
+        for (Slot& slot : slots) {
+            bool expected = false;
+            if (!slot.claimed.load(std::memory_order_relaxed) &&
+                slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return &slot;
+            }
+        }
+        throw std::runtime_error("Too many threads reading observer lists");
+    }
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    void enter() {
+        ThreadState& mine = state();
+        if (!mine.slot) {
+            mine.slot = claim();
+        }
+        if (mine.depth++ == 0) {
+            mine.slot->epoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+    }
+
+    void leave() {
+        ThreadState& mine = state();
+        if (--mine.depth == 0) {
+            mine.slot->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    bool reading() const {
+        return state().depth > 0;
+    }
+
+    std::uint64_t current() const {
+        return globalEpoch.load(std::memory_order_seq_cst);
+    }
+
+    // Call right after unpublishing an object; returns the epoch to retire it with
+    std::uint64_t advance() {
+        return globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    // Objects retired with an epoch below this can be freed
+    std::uint64_t oldestActive() const {
+        std::uint64_t oldest = UINT64_MAX;
+        for (const Slot& slot : slots) {
+            std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0) {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        return oldest;
+    }
+
+    // Waits until no reader can still see what was retired with `epoch`
+    void synchronize(std::uint64_t epoch) const {
+        while (oldestActive() <= epoch) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+class EpochGuard {
+public:
+    EpochGuard() {
+        EpochDomain::instance().enter();
+    }
+
+    ~EpochGuard() {
+        EpochDomain::instance().leave();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+// The observer list is an immutable snapshot. notify() takes no lock: it pins the
+// current snapshot with an EpochGuard and iterates it. attach() and detach() copy the
+// list under a writer mutex, publish the copy and retire the old snapshot, which is
+// freed once no notify() can still be reading it; neither waits for readers. Any
+// thread may publish, attach or detach concurrently, including from inside update().
 class NewsAgency : public Subject {
 private:
-    std::vector<Observer*> observers; // List of observers
-    std::string latestNews;           // Subject state
+    struct Subscription {
+        Observer* observer;
+        std::shared_ptr<ObserverMailbox> mailbox; // Null: updated synchronously
+    };
+
+    using Snapshot = std::vector<Subscription>;
+
+    std::atomic<const Snapshot*> observers; // List of observers
+    std::mutex writers;
+    std::vector<std::pair<std::uint64_t, const Snapshot*>> retired;
+    // The latest message lives in a cell that readers pin like a snapshot. A
+    // replaced cell goes on a lock-free retired list, tagged with the current epoch,
+    // and is freed by whichever writer next holds `writers`.
+    struct NewsCell {
+        NewsMessage message;
+        std::uint64_t retiredAt = 0;
+        NewsCell* next = nullptr;
+    };
+
+    std::atomic<NewsCell*> latestNews; // Subject state
+    std::atomic<NewsCell*> retiredNews{nullptr};
+    std::atomic<std::uint32_t> newsSinceReclaim{0};
+    NotificationPool* pool;
+
+    // Publisher statistics stay off the shared read path: each thread counts on its
+    // own stripe and only times one notify in kTimingSample
+    static constexpr std::size_t kStatStripes = 16;
+    static constexpr std::uint64_t kTimingSample = 8;
+
+    struct alignas(64) StatStripe {
+        std::atomic<std::uint64_t> notifications{0};
+        std::atomic<std::uint64_t> timed{0};
+        std::atomic<std::int64_t> nanos{0};
+        std::atomic<std::int64_t> worst{0};
+    };
+
+    StatStripe stats[kStatStripes];
+
+    static std::size_t statStripe() {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local std::size_t mine = nextStripe.fetch_add(1, std::memory_order_relaxed) % kStatStripes;
+        return mine;
+    }
+
+    // Caller holds `writers`. Returns the epoch the old snapshot was retired with.
+    std::uint64_t publish(Snapshot* next) {
+        const Snapshot* previous = observers.exchange(next, std::memory_order_seq_cst);
+        EpochDomain& domain = EpochDomain::instance();
+        std::uint64_t epoch = domain.advance();
+        retired.emplace_back(epoch, previous);
+        std::uint64_t oldest = domain.oldestActive();
+        auto reclaimable = std::partition(retired.begin(), retired.end(),
+                                          [&](const auto& entry) { return entry.first >= oldest; });
+        for (auto it = reclaimable; it != retired.end(); ++it) {
+            delete it->second;
+        }
+        retired.erase(reclaimable, retired.end());
+        reclaimNews(oldest);
+        return epoch;
+    }
+
+    // Caller holds `writers`, so it is the only one taking cells off the list
+    void reclaimNews(std::uint64_t oldest) {
+        NewsCell* cell = retiredNews.exchange(nullptr, std::memory_order_acquire);
+        while (cell) {
+            NewsCell* next = cell->next;
+            if (cell->retiredAt < oldest) {
+                delete cell;
+            } else {
+                retire(cell, cell->retiredAt);
+            }
+            cell = next;
+        }
+    }
+
+    void retire(NewsCell* cell, std::uint64_t epoch) {
+        cell->retiredAt = epoch;
+        cell->next = retiredNews.load(std::memory_order_relaxed);
+        while (!retiredNews.compare_exchange_weak(cell->next, cell, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+        }
+    }
+
+    // Caller holds an EpochGuard, which pins the observer snapshot
+    void deliver(const NewsMessage& message) {
+        using Clock = std::chrono::steady_clock;
+        StatStripe& stripe = stats[statStripe()];
+        bool timed = stripe.notifications.fetch_add(1, std::memory_order_relaxed) % kTimingSample == 0;
+        Clock::time_point start = timed ? Clock::now() : Clock::time_point{};
+        for (const Subscription& subscription : *observers.load(std::memory_order_seq_cst)) {
+            if (!subscription.mailbox) {
+                subscription.observer->update(*message);
+                continue;
+            }
+            if (start == Clock::time_point{}) {
+                start = Clock::now(); // Mailboxes need the publish time to report lag
+            }
+            if (subscription.mailbox->post(message, start)) {
+                pool->schedule(subscription.mailbox);
+            }
+        }
+        if (!timed) {
+            return;
+        }
+        std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        stripe.timed.fetch_add(1, std::memory_order_relaxed);
+        stripe.nanos.fetch_add(elapsed, std::memory_order_relaxed);
+        std::int64_t worst = stripe.worst.load(std::memory_order_relaxed);
+        while (elapsed > worst && !stripe.worst.compare_exchange_weak(worst, elapsed, std::memory_order_relaxed)) {
+        }
+    }
+
+    void add(Subscription subscription) {
+        std::lock_guard<std::mutex> lock(writers);
+        auto* next = new Snapshot(*observers.load());
+        next->push_back(std::move(subscription));
+        publish(next);
+    }
 
 public:
+    // Without a pool every observer is updated synchronously inside notify()
+    explicit NewsAgency(NotificationPool* pool = nullptr)
+        : observers(new Snapshot), latestNews(new NewsCell{std::make_shared<const std::string>()}), pool(pool) {}
+
+    NewsAgency(const NewsAgency&) = delete;
+    NewsAgency& operator=(const NewsAgency&) = delete;
+
+    // No thread may still be publishing through the agency
+    ~NewsAgency() {
+        const Snapshot* current = observers.load();
+        for (const auto& subscription : *current) {
+            if (subscription.mailbox) {
+                subscription.mailbox->close();
+            }
+        }
+        delete current;
+        for (const auto& entry : retired) {
+            delete entry.second;
+        }
+        delete latestNews.load();
+        for (NewsCell* cell = retiredNews.load(); cell;) {
+            NewsCell* next = cell->next;
+            delete cell;
+            cell = next;
+        }
+    }
+
     void attach(Observer* observer) override {
-        observers.push_back(observer);
+        if (pool) {
+            attach(observer, DeliveryOptions{});
+        } else {
+            add(Subscription{observer, nullptr});
+        }
     }
 
+    void attach(Observer* observer, DeliveryOptions options) {
+        if (!pool) {
+            throw std::logic_error("Asynchronous delivery needs a NotificationPool");
+        }
+        add(Subscription{observer, std::make_shared<ObserverMailbox>(observer, options)});
+    }
+
+    // Publishes the list without the observer and returns without waiting for readers.
+    // An asynchronous observer gets no further update() once this returns; a
+    // synchronous one may still be updated by a notify() already in flight, so call
+    // synchronize() before destroying it.
     void detach(Observer* observer) override {
-        observers.erase(
-            std::remove(observers.begin(), observers.end(), observer),
-            observers.end());
+        std::vector<std::shared_ptr<ObserverMailbox>> closing;
+        {
+            std::lock_guard<std::mutex> lock(writers);
+            auto* next = new Snapshot;
+            for (const auto& subscription : *observers.load()) {
+                if (subscription.observer != observer) {
+                    next->push_back(subscription);
+                } else if (subscription.mailbox) {
+                    closing.push_back(subscription.mailbox);
+                }
+            }
+            publish(next);
+        }
+        for (auto& mailbox : closing) {
+            mailbox->close();
+        }
+    }
+
+    // Blocks until every notify() that could still see an observer detached before
+    // the call has returned. Cannot be called from inside update(), which would wait
+    // for itself.
+    void synchronize() const {
+        EpochDomain& domain = EpochDomain::instance();
+        if (domain.reading()) {
+            throw std::logic_error("NewsAgency::synchronize() called from inside update()");
+        }
+        domain.synchronize(domain.advance());
     }
 
     void notify() override {
-        for (Observer* observer : observers) {
+        // The guard pins the news cell as well as the snapshot, so the message is not copied
+        EpochGuard guard;
+        deliver(latestNews.load(std::memory_order_seq_cst)->message);
+    }
+
+    void setNews(const std::string& news) {
+        setNews(std::make_shared<const std::string>(news));
+    }
+
+    // Publishes an already-built message, which may be shared with other agencies
+    void setNews(NewsMessage news) {
+        NewsCell* previous = latestNews.exchange(new NewsCell{news}, std::memory_order_seq_cst);
+        retire(previous, EpochDomain::instance().current());
+        {
+            EpochGuard guard;
+            deliver(news); // Notify observers of the change
+        }
+        // Publishers reclaim too, every so often, so the retired list stays short
+        // without attach() or detach(); but they never wait for a writer to do it
+        if (newsSinceReclaim.fetch_add(1, std::memory_order_relaxed) % 64 != 63) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(writers, std::try_to_lock);
+        if (lock.owns_lock()) {
+            EpochDomain& domain = EpochDomain::instance();
+            domain.advance();
+            reclaimNews(domain.oldestActive());
+        }
+    }
+
+    // Waits until every asynchronous observer has caught up
+    void flush() {
+        EpochGuard guard;
+        for (const auto& subscription : *observers.load()) {
+            if (subscription.mailbox) {
+                subscription.mailbox->waitIdle();
+            }
+        }
+    }
+
+    ObserverLag lag(Observer* observer) const {
+        EpochGuard guard;
+        for (const auto& subscription : *observers.load()) {
+            if (subscription.observer == observer && subscription.mailbox) {
+                return subscription.mailbox->lag();
+            }
+        }
+        return ObserverLag{};
+    }
+
+    std::size_t observerCount() const {
+        EpochGuard guard;
+        return observers.load()->size();
+    }
+
+    PublisherStats publisherStats() const {
+        PublisherStats result;
+        for (const StatStripe& stripe : stats) {
+            result.notifications += stripe.notifications.load(std::memory_order_relaxed);
+            result.timed += stripe.timed.load(std::memory_order_relaxed);
+            result.total += std::chrono::nanoseconds(stripe.nanos.load(std::memory_order_relaxed));
+            result.worst = std::max(result.worst, std::chrono::nanoseconds(stripe.worst.load(std::memory_order_relaxed)));
+        }
+        return result;
+    }
+};
+
+// Handle-based registry
+// A slot map: attach returns a handle (slot index + generation) and detach is O(1).
+// Observers sit in a dense array that notify() walks with no holes; detaching moves
+// the last observer into the freed place, so notification order is not attach order.
+// Freeing a slot bumps its generation, so stale handles are recognised and ignored.
+struct ObserverHandle {
+    std::uint32_t slot = UINT32_MAX;
+    std::uint32_t generation = 0;
+};
+
+class ObserverSlotMap {
+private:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    struct Slot {
+        std::uint32_t generation = 0;
+        std::uint32_t link = kNone; // Dense index while live, next free slot while free
+    };
+
+    std::vector<Slot> slots;
+    std::vector<Observer*> dense;
+    std::vector<std::uint32_t> denseSlots; // Slot owning each dense entry
+    std::uint32_t freeHead = kNone;
+
+public:
+    ObserverHandle insert(Observer* observer) {
+        std::uint32_t slot = freeHead;
+        if (slot != kNone) {
+            freeHead = slots[slot].link;
+        } else {
+            if (slots.size() == kNone) {
+                throw std::length_error("Observer slot map is full");
+            }
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        slots[slot].link = static_cast<std::uint32_t>(dense.size());
+        dense.push_back(observer);
+        denseSlots.push_back(slot);
+        return ObserverHandle{slot, slots[slot].generation};
+    }
+
+    bool contains(ObserverHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+    }
+
+    // False for a stale or unknown handle
+    bool erase(ObserverHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots[handle.slot];
+        std::uint32_t hole = slot.link;
+        dense[hole] = dense.back();
+        denseSlots[hole] = denseSlots.back();
+        slots[denseSlots[hole]].link = hole;
+        dense.pop_back();
+        denseSlots.pop_back();
+        ++slot.generation;
+        slot.link = freeHead;
+        freeHead = handle.slot;
+        return true;
+    }
+
+    const std::vector<Observer*>& observers() const {
+        return dense;
+    }
+};
+
+// Single-threaded agency for very large, fast-changing audiences. It gives up
+// NewsAgency's concurrent snapshots, whose every change copies the list, for O(1)
+// subscribe and unsubscribe. Unsubscribing from inside update() is deferred until
+// the notification finishes.
+class SlotMapNewsAgency : public Subject {
+private:
+    ObserverSlotMap registry;
+    std::unordered_map<Observer*, ObserverHandle> attached; // For the pointer-based Subject interface
+    std::vector<ObserverHandle> deferred;
+    bool notifying = false;
+    std::string latestNews;
+
+public:
+    ObserverHandle subscribe(Observer* observer) {
+        if (notifying) {
+            throw std::logic_error("Cannot subscribe during notify()");
+        }
+        return registry.insert(observer);
+    }
+
+    bool unsubscribe(ObserverHandle handle) {
+        if (notifying) {
+            bool live = registry.contains(handle);
+            if (live) {
+                deferred.push_back(handle);
+            }
+            return live;
+        }
+        return registry.erase(handle);
+    }
+
+    // Attaching an observer that is already attached has no effect
+    void attach(Observer* observer) override {
+        if (attached.find(observer) == attached.end()) {
+            attached.emplace(observer, subscribe(observer));
+        }
+    }
+
+    void detach(Observer* observer) override {
+        auto it = attached.find(observer);
+        if (it != attached.end()) {
+            unsubscribe(it->second);
+            attached.erase(it);
+        }
+    }
+
+    void notify() override {
+        // Ends the notification even if update() throws, applying deferred unsubscribes
+        struct Finish {
+            SlotMapNewsAgency& agency;
+            ~Finish() {
+                agency.notifying = false;
+                for (ObserverHandle handle : agency.deferred) {
+                    agency.registry.erase(handle);
+                }
+                agency.deferred.clear();
+            }
+        };
+        notifying = true;
+        Finish finish{*this};
+        for (Observer* observer : registry.observers()) {
             observer->update(latestNews);
         }
     }
@@ -72,8 +805,11 @@ public:
         latestNews = news;
         notify(); // Notify observers of the change
     }
-};
 
+    std::size_t observerCount() const {
+        return registry.observers().size();
+    }
+};
 
 class Subscriber : public Observer {
 private:
@@ -87,6 +823,261 @@ public:
     }
 };
 
+// Silent observer that takes a fixed time per update
+class SlowSubscriber : public Observer {
+private:
+    std::chrono::microseconds cost;
+
+public:
+    explicit SlowSubscriber(std::chrono::microseconds cost) : cost(cost) {}
+
+    void update(const std::string&) override {
+        std::this_thread::sleep_for(cost);
+    }
+};
+
+// Benchmark: one publisher, seven fast observers and one that needs 200 us per update.
+// Synchronous delivery makes the publisher pay for the slow one; asynchronous delivery
+// shows what each overload policy does to the publisher and to the slow observer's lag.
+void benchmarkFanOut(int messages) {
+    using namespace std::chrono;
+    struct Mode {
+        const char* label;
+        bool async;
+        OverloadPolicy overload;
+    };
+    for (const Mode& mode : {Mode{"Synchronous", false, OverloadPolicy::DropOldest},
+                             Mode{"Async, drop-oldest", true, OverloadPolicy::DropOldest},
+                             Mode{"Async, block", true, OverloadPolicy::Block},
+                             Mode{"Async, coalesce", true, OverloadPolicy::Coalesce}}) {
+        NotificationPool pool(4);
+        NewsAgency agency(mode.async ? &pool : nullptr);
+        std::vector<std::unique_ptr<SlowSubscriber>> fast;
+        for (int i = 0; i < 7; ++i) {
+            fast.push_back(std::make_unique<SlowSubscriber>(microseconds(0)));
+            agency.attach(fast.back().get());
+        }
+        SlowSubscriber slow(microseconds(200));
+        if (mode.async) {
+            agency.attach(&slow, DeliveryOptions{32, mode.overload});
+        } else {
+            agency.attach(&slow);
+        }
+
+        auto start = steady_clock::now();
+        for (int i = 0; i < messages; ++i) {
+            agency.setNews("Headline " + std::to_string(i));
+            std::this_thread::sleep_for(microseconds(50)); // Publishing faster than the slow observer keeps up
+        }
+        double publishSeconds = duration<double>(steady_clock::now() - start).count();
+        ObserverLag lag = agency.lag(&slow);
+        agency.flush();
+        PublisherStats stats = agency.publisherStats();
+        std::cout << mode.label << ": " << messages / publishSeconds << " messages/sec, notify avg "
+                  << duration<double, std::micro>(stats.average()).count() << " us, worst "
+                  << duration<double, std::micro>(stats.worst).count() << " us";
+        if (mode.async) {
+            std::cout << "; slow observer " << lag.pending << " pending, " << lag.delivered << " delivered, "
+                      << lag.dropped << " dropped, " << lag.coalesced << " coalesced, lag "
+                      << duration<double, std::milli>(lag.lastLatency).count() << " ms";
+        }
+        std::cout << "\n";
+    }
+}
+
+// Counts updates; safe to share between publisher threads
+class CountingSubscriber : public Observer {
+public:
+    std::atomic<std::uint64_t> updates{0};
+
+    void update(const std::string&) override {
+        updates.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// The straightforward thread-safe list, for comparison: notify() holds a shared lock
+class LockedObserverList {
+private:
+    mutable std::shared_mutex mutex;
+    std::vector<Observer*> observers;
+
+public:
+    void attach(Observer* observer) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        observers.push_back(observer);
+    }
+
+    void detach(Observer* observer) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    }
+
+    void notify(const std::string& message) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (Observer* observer : observers) {
+            observer->update(message);
+        }
+    }
+};
+
+// Benchmark: 1-8 publisher threads notifying 64 observers of the same message as fast
+// as they can while another thread keeps attaching and detaching 16 more. Both lists
+// only run notify(); neither publishes a new message per call.
+template <typename List>
+void benchmarkConcurrentNotify(const char* label, List& list, int publishers) {
+    using namespace std::chrono;
+    std::vector<CountingSubscriber> stable(64), churning(16);
+    const NewsMessage message = std::make_shared<const std::string>("tick");
+    if constexpr (std::is_same_v<List, NewsAgency>) {
+        list.setNews(message);
+    }
+    for (auto& observer : stable) {
+        list.attach(&observer);
+    }
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> notifies{0}, churns{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; ++p) {
+        threads.emplace_back([&] {
+            std::uint64_t mine = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                if constexpr (std::is_same_v<List, NewsAgency>) {
+                    list.notify();
+                } else {
+                    list.notify(*message);
+                }
+                ++mine;
+            }
+            notifies += mine;
+        });
+    }
+    threads.emplace_back([&] {
+        std::uint64_t mine = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            for (auto& observer : churning) {
+                list.attach(&observer);
+            }
+            for (auto& observer : churning) {
+                list.detach(&observer);
+            }
+            mine += churning.size() * 2;
+        }
+        churns += mine;
+    });
+    auto start = steady_clock::now();
+    std::this_thread::sleep_for(milliseconds(300));
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = duration<double>(steady_clock::now() - start).count();
+    for (auto& observer : stable) {
+        list.detach(&observer);
+    }
+    std::cout << label << ", " << publishers << " publishers: " << notifies / seconds / 1e3 << "K notifies/sec, "
+              << churns / seconds / 1e3 << "K attach+detach/sec\n";
+}
+
+// The original registry, for comparison: detach searches and compacts the vector
+class VectorObserverList {
+private:
+    std::vector<Observer*> observers;
+
+public:
+    void attach(Observer* observer) {
+        observers.push_back(observer);
+    }
+
+    void detach(Observer* observer) {
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    }
+
+    void notify(const std::string& message) {
+        for (Observer* observer : observers) {
+            observer->update(message);
+        }
+    }
+};
+
+// Benchmark: attach N observers, then 2000 churn steps (detach a random observer,
+// attach a replacement), then one notification, then detaching everyone. The full
+// detach is quadratic for the vector, so above `measureLimit` observers it is only
+// projected from the churn cost, and labelled as such.
+void benchmarkChurn(std::size_t count, std::size_t measureLimit = 100'000) {
+    using namespace std::chrono;
+    constexpr std::size_t kChurn = 2'000;
+    std::vector<CountingSubscriber> audience(count + kChurn);
+    std::mt19937 random(3);
+    std::vector<std::size_t> victims(kChurn);
+    for (auto& victim : victims) {
+        victim = random() % count;
+    }
+    auto nanosPer = [](steady_clock::duration elapsed, std::size_t operations) {
+        return duration<double, std::nano>(elapsed).count() / operations;
+    };
+    const std::string message = "tick";
+
+    {
+        SlotMapNewsAgency agency;
+        std::vector<ObserverHandle> handles(count);
+        auto start = steady_clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            handles[i] = agency.subscribe(&audience[i]);
+        }
+        double attach = nanosPer(steady_clock::now() - start, count);
+        start = steady_clock::now();
+        for (std::size_t step = 0; step < kChurn; ++step) {
+            std::size_t victim = victims[step];
+            agency.unsubscribe(handles[victim]);
+            handles[victim] = agency.subscribe(&audience[count + step]);
+        }
+        double churn = nanosPer(steady_clock::now() - start, kChurn);
+        start = steady_clock::now();
+        agency.setNews(message);
+        double notify = nanosPer(steady_clock::now() - start, count);
+        start = steady_clock::now();
+        for (ObserverHandle handle : handles) {
+            agency.unsubscribe(handle);
+        }
+        double teardown = duration<double, std::milli>(steady_clock::now() - start).count();
+        std::cout << count << " observers, slot map: attach " << attach << " ns, churn " << churn
+                  << " ns/step, notify " << notify << " ns/observer, detach all " << teardown << " ms\n";
+    }
+    {
+        VectorObserverList list;
+        std::vector<Observer*> current(count);
+        auto start = steady_clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            list.attach(&audience[i]);
+            current[i] = &audience[i];
+        }
+        double attach = nanosPer(steady_clock::now() - start, count);
+        start = steady_clock::now();
+        for (std::size_t step = 0; step < kChurn; ++step) {
+            std::size_t victim = victims[step];
+            list.detach(current[victim]);
+            current[victim] = &audience[count + step];
+            list.attach(current[victim]);
+        }
+        double churn = nanosPer(steady_clock::now() - start, kChurn);
+        start = steady_clock::now();
+        list.notify(message);
+        double notify = nanosPer(steady_clock::now() - start, count);
+        std::cout << count << " observers, vector: attach " << attach << " ns, churn " << churn
+                  << " ns/step, notify " << notify << " ns/observer, detach all ";
+        if (count <= measureLimit) {
+            start = steady_clock::now();
+            for (Observer* observer : current) {
+                list.detach(observer);
+            }
+            std::cout << duration<double, std::milli>(steady_clock::now() - start).count() << " ms\n";
+        } else {
+            std::cout << "~" << churn * count / 1e6 << " ms (projected from churn, not measured)\n";
+        }
+    }
+}
+
 int main() {
     // Create the subject
     NewsAgency agency;
@@ -109,6 +1100,68 @@ int main() {
     // Change the subject's state again
     agency.setNews("Update: Observer Pattern is Awesome!");
 
+    // Asynchronous delivery; one worker keeps the demo output in order
+    {
+        NotificationPool pool(1);
+        NewsAgency wire(&pool);
+        wire.attach(&alice);
+        wire.attach(&charlie, DeliveryOptions{1, OverloadPolicy::Coalesce});
+        wire.setNews("Async: Markets open");
+        wire.flush();
+        std::cout << "Charlie delivered " << wire.lag(&charlie).delivered << ", publisher notified "
+                  << wire.publisherStats().notifications << " time(s)\n";
+    }
+
+    benchmarkFanOut(2'000);
+
+    // An observer that unsubscribes itself from inside update()
+    {
+        class OneShot : public Observer {
+        private:
+            NewsAgency& agency;
+
+        public:
+            explicit OneShot(NewsAgency& agency) : agency(agency) {}
+
+            void update(const std::string& message) override {
+                std::cout << "One-shot received: " << message << "\n";
+                agency.detach(this);
+            }
+        };
+
+        NewsAgency flash;
+        OneShot once(flash);
+        flash.attach(&alice);
+        flash.attach(&once);
+        flash.setNews("Flash: first");
+        flash.setNews("Flash: second");
+    }
+
+    for (int publishers : {1, 2, 4, 8}) {
+        NewsAgency agency;
+        benchmarkConcurrentNotify("Copy-on-write", agency, publishers);
+        LockedObserverList locked;
+        benchmarkConcurrentNotify("shared_mutex", locked, publishers);
+    }
+
+    // Handle-based subscriptions
+    {
+        SlotMapNewsAgency bulletin;
+        ObserverHandle aliceHandle = bulletin.subscribe(&alice);
+        ObserverHandle bobHandle = bulletin.subscribe(&bob);
+        bulletin.unsubscribe(bobHandle);
+        ObserverHandle charlieHandle = bulletin.subscribe(&charlie); // Reuses Bob's slot
+        std::cout << "Bob's stale handle " << (bulletin.unsubscribe(bobHandle) ? "removed someone" : "is ignored")
+                  << "\n";
+        bulletin.setNews("Bulletin: Slot maps are O(1)");
+        bulletin.unsubscribe(aliceHandle);
+        bulletin.unsubscribe(charlieHandle);
+    }
+
+    for (std::size_t count : {10'000, 100'000, 1'000'000}) {
+        benchmarkChurn(count);
+    }
+
     return 0;
 }
 
@@ -116,6 +1169,29 @@ int main() {
 //Alice received update: Breaking News: Observer Pattern Implemented!
 //Bob received update: Breaking News: Observer Pattern Implemented!
 //Alice received update: Update: Observer Pattern is Awesome!
+//Alice received update: Async: Markets open
+//Charlie received update: Async: Markets open
+//Charlie delivered 1, publisher notified 1 time(s)
+//Synchronous: ... messages/sec, notify avg ... us, worst ... us
+//Async, drop-oldest: ... messages/sec, notify avg ... us, worst ... us; slow observer ... pending, ... delivered, ... dropped, 0 coalesced, lag ... ms
+//Async, block: ... messages/sec, notify avg ... us, worst ... us; slow observer ... pending, ... delivered, 0 dropped, 0 coalesced, lag ... ms
+//Async, coalesce: ... messages/sec, notify avg ... us, worst ... us; slow observer ... pending, ... delivered, 0 dropped, ... coalesced, lag ... ms
+//Alice received update: Flash: first
+//One-shot received: Flash: first
+//Alice received update: Flash: second
+//Copy-on-write, 1 publishers: ...K notifies/sec, ...K attach+detach/sec
+//shared_mutex, 1 publishers: ...K notifies/sec, ...K attach+detach/sec
+//...
+//Copy-on-write, 8 publishers: ...K notifies/sec, ...K attach+detach/sec
+//shared_mutex, 8 publishers: ...K notifies/sec, ...K attach+detach/sec
+//Bob's stale handle is ignored
+//Alice received update: Bulletin: Slot maps are O(1)
+//Charlie received update: Bulletin: Slot maps are O(1)
+//10000 observers, slot map: attach ... ns, churn ... ns/step, notify ... ns/observer, detach all ... ms
+//10000 observers, vector: attach ... ns, churn ... ns/step, notify ... ns/observer, detach all ... ms
+//...
+//1000000 observers, slot map: attach ... ns, churn ... ns/step, notify ... ns/observer, detach all ... ms
+//1000000 observers, vector: attach ... ns, churn ... ns/step, notify ... ns/observer, detach all ~... ms (projected from churn, not measured)
 
 //
 //Key Features of the Observer Pattern
@@ -124,13 +1200,15 @@ int main() {
 //Dynamic Relationships:
 //Observers can be added or removed at runtime.
 //Scalability:
-//Supports one-to-many relationships between objects.
+//Supports one-to-many relationships between objects. With very large audiences, handle-based subscriptions in a slot map keep unsubscribing O(1) where searching a vector is O(n).
 //Real-World Applications
 //Event Systems: GUIs where button clicks notify listeners.
 //Publish-Subscribe Models: News feeds, email alerts, or stock market updates.
 //Data Binding: Synchronizing UI elements with underlying data.
 //Caveats
 //Performance:
-//Notifying a large number of observers can be slow.
+//Notifying a large number of observers can be slow. Synchronous notification also lets the slowest observer set the publisher's pace; per-observer bounded queues with an explicit overload policy decouple them.
 //Unintended Dependencies:
 //Observers must handle updates carefully to avoid inconsistencies or infinite loops.
+//Concurrency:
+//Attaching or detaching while another thread, or update() itself, is notifying invalidates a plain vector being iterated. Notifying from an immutable snapshot that writers replace, with reclamation deferred until readers are done, makes both safe without locking the notify path.
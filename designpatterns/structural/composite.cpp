@@ -33,11 +33,27 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <fstream>
+#include <stdexcept>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <bit>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class OrgTreeWriter;
 
 // Component Interface
 class Employee {
 public:
     virtual void showDetails() const = 0; // Common operation for both leaves and composites
+    virtual void writeTo(OrgTreeWriter& writer) const = 0; // Emits this node into a binary org tree
     virtual ~Employee() = default;
 };
 
@@ -53,6 +69,8 @@ public:
     void showDetails() const override {
         std::cout << "Developer: " << name << ", Position: " << position << std::endl;
     }
+
+    void writeTo(OrgTreeWriter& writer) const override;
 };
 
 class Designer : public Employee {
@@ -67,6 +85,8 @@ public:
     void showDetails() const override {
         std::cout << "Designer: " << name << ", Position: " << position << std::endl;
     }
+
+    void writeTo(OrgTreeWriter& writer) const override;
 };
 
 
@@ -88,8 +108,304 @@ public:
             employee->showDetails();
         }
     }
+
+    void writeTo(OrgTreeWriter& writer) const override;
+};
+
+// Binary Org Tree Format
+// The whole hierarchy is stored as one flat, position-independent image:
+//
+//   OrgTreeHeader | OrgTreeNode[nodeCount] | string table
+//
+// Nodes are laid out breadth-first, so the children of a manager are the contiguous
+// range [firstChild, firstChild + childCount). Names and positions are offsets into the
+// string table (duplicates are stored once). There are no pointers, so the file can be
+// memory-mapped at any address and walked in place. Integers are little-endian.
+enum class OrgNodeKind : std::uint32_t {
+    Developer = 1,
+    Designer = 2,
+    Manager = 3
+};
+
+struct OrgTreeHeader {
+    char magic[4];              // "ORGT"
+    std::uint32_t version;
+    std::uint64_t nodeCount;
+    std::uint64_t nodesOffset;  // Byte offset of the node array from the start of the file
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+};
+
+struct OrgTreeNode {
+    OrgNodeKind kind;
+    std::uint32_t nameOffset;   // Offsets are relative to the string table
+    std::uint32_t nameLength;
+    std::uint32_t positionOffset;
+    std::uint32_t positionLength;
+    std::uint32_t childCount;
+    std::uint64_t firstChild;   // Index into the node array
+};
+
+static_assert(sizeof(OrgTreeHeader) == 40, "OrgTreeHeader layout must not change");
+static_assert(sizeof(OrgTreeNode) == 32, "OrgTreeNode layout must not change");
+static_assert(std::endian::native == std::endian::little,
+              "The org tree image is read and written in place, so the host must be little-endian");
+
+constexpr char kOrgTreeMagic[4] = {'O', 'R', 'G', 'T'};
+constexpr std::uint32_t kOrgTreeVersion = 1;
+
+// Writer: flattens an Employee tree into the binary format
+class OrgTreeWriter {
+private:
+    std::vector<OrgTreeNode> nodes;
+    std::vector<const Employee*> pending; // Breadth-first queue; pending[i] becomes nodes[i]
+    std::string strings;
+    std::unordered_map<std::string, std::uint32_t> interned;
+
+    std::uint32_t intern(const std::string& text) {
+        auto it = interned.find(text);
+        if (it != interned.end()) {
+            return it->second;
+        }
+        if (strings.size() + text.size() > UINT32_MAX) {
+            throw std::length_error("Org tree string table exceeds 4 GiB");
+        }
+        auto offset = static_cast<std::uint32_t>(strings.size());
+        strings += text;
+        interned.emplace(text, offset);
+        return offset;
+    }
+
+    OrgTreeNode& current() {
+        return nodes.back();
+    }
+
+public:
+    // Called back from Employee::writeTo for leaves
+    void leaf(OrgNodeKind kind, const std::string& name, const std::string& position) {
+        OrgTreeNode& node = current();
+        node.kind = kind;
+        node.nameOffset = intern(name);
+        node.nameLength = static_cast<std::uint32_t>(name.size());
+        node.positionOffset = intern(position);
+        node.positionLength = static_cast<std::uint32_t>(position.size());
+    }
+
+    // Called back from Employee::writeTo for composites; children are queued breadth-first
+    void manager(const std::string& name, const std::vector<std::shared_ptr<Employee>>& team) {
+        OrgTreeNode& node = current();
+        node.kind = OrgNodeKind::Manager;
+        node.nameOffset = intern(name);
+        node.nameLength = static_cast<std::uint32_t>(name.size());
+        node.firstChild = pending.size();
+        node.childCount = static_cast<std::uint32_t>(team.size());
+        for (const auto& employee : team) {
+            pending.push_back(employee.get());
+        }
+    }
+
+    void save(const Employee& root, const std::string& path) {
+        nodes.clear();
+        pending.assign(1, &root);
+        strings.clear();
+        interned.clear();
+
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            nodes.push_back(OrgTreeNode{});
+            pending[i]->writeTo(*this);
+        }
+
+        OrgTreeHeader header{};
+        std::memcpy(header.magic, kOrgTreeMagic, sizeof(header.magic));
+        header.version = kOrgTreeVersion;
+        header.nodeCount = nodes.size();
+        header.nodesOffset = sizeof(OrgTreeHeader);
+        header.stringsOffset = header.nodesOffset + nodes.size() * sizeof(OrgTreeNode);
+        header.stringsSize = strings.size();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open " + path + " for writing");
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(nodes.data()),
+                  static_cast<std::streamsize>(nodes.size() * sizeof(OrgTreeNode)));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!out) {
+            throw std::runtime_error("Failed writing " + path);
+        }
+    }
+};
+
+void Developer::writeTo(OrgTreeWriter& writer) const {
+    writer.leaf(OrgNodeKind::Developer, name, position);
+}
+
+void Designer::writeTo(OrgTreeWriter& writer) const {
+    writer.leaf(OrgNodeKind::Designer, name, position);
+}
+
+void Manager::writeTo(OrgTreeWriter& writer) const {
+    writer.manager(name, team);
+}
+
+// Reader: maps the file and exposes the hierarchy in place, without parsing or allocating.
+// Opening only validates the header, so it stays O(1) however large the tree is; each
+// node's string and child ranges are checked when they are used, and a corrupt file
+// throws instead of reading outside the mapping.
+class MappedOrgTree {
+private:
+    const char* base = nullptr;
+    std::size_t size = 0;
+    const OrgTreeHeader* header = nullptr;
+    const OrgTreeNode* nodes = nullptr;
+    const char* strings = nullptr;
+
+    std::string_view text(std::uint32_t offset, std::uint32_t length) const {
+        if (std::uint64_t{offset} + length > header->stringsSize) {
+            throw std::runtime_error("Corrupt org tree: string outside the string table");
+        }
+        return std::string_view(strings + offset, length);
+    }
+
+    const OrgTreeNode* at(std::uint64_t index) const {
+        if (index >= header->nodeCount) {
+            throw std::out_of_range("Org tree node index out of range");
+        }
+        return nodes + index;
+    }
+
+    // Children are laid out after their parent, which also rules out cycles
+    const OrgTreeNode* childOf(const OrgTreeNode* parent, std::size_t i) const {
+        if (i >= parent->childCount) {
+            throw std::out_of_range("Org tree child index out of range");
+        }
+        std::uint64_t self = static_cast<std::uint64_t>(parent - nodes);
+        if (parent->firstChild <= self || parent->firstChild > header->nodeCount ||
+            parent->childCount > header->nodeCount - parent->firstChild) {
+            throw std::runtime_error("Corrupt org tree: child range outside the node array");
+        }
+        return nodes + parent->firstChild + i;
+    }
+
+    void validate(const std::string& path) const {
+        auto fail = [&](const char* why) {
+            throw std::runtime_error(path + ": " + why);
+        };
+        if (size < sizeof(OrgTreeHeader)) fail("file too small");
+        if (std::memcmp(header->magic, kOrgTreeMagic, sizeof(kOrgTreeMagic)) != 0) fail("bad magic");
+        if (header->version != kOrgTreeVersion) fail("unsupported version");
+        if (header->nodeCount == 0) fail("empty tree");
+        if (header->nodesOffset != sizeof(OrgTreeHeader) ||
+            header->nodeCount > (size - header->nodesOffset) / sizeof(OrgTreeNode) ||
+            header->stringsOffset != header->nodesOffset + header->nodeCount * sizeof(OrgTreeNode) ||
+            header->stringsSize > size - header->stringsOffset) {
+            fail("truncated or corrupt layout");
+        }
+    }
+
+public:
+    class Node {
+    private:
+        const MappedOrgTree* tree;
+        const OrgTreeNode* node;
+
+    public:
+        Node(const MappedOrgTree* tree, const OrgTreeNode* node) : tree(tree), node(node) {}
+
+        OrgNodeKind kind() const {
+            if (node->kind < OrgNodeKind::Developer || node->kind > OrgNodeKind::Manager) {
+                throw std::runtime_error("Corrupt org tree: unknown node kind");
+            }
+            return node->kind;
+        }
+        std::string_view name() const { return tree->text(node->nameOffset, node->nameLength); }
+        std::string_view position() const { return tree->text(node->positionOffset, node->positionLength); }
+        std::size_t childCount() const { return node->childCount; }
+        Node child(std::size_t i) const { return Node(tree, tree->childOf(node, i)); }
+
+        // Same output as Employee::showDetails, straight from the mapping
+        void showDetails() const {
+            switch (kind()) {
+            case OrgNodeKind::Developer:
+                std::cout << "Developer: " << name() << ", Position: " << position() << std::endl;
+                break;
+            case OrgNodeKind::Designer:
+                std::cout << "Designer: " << name() << ", Position: " << position() << std::endl;
+                break;
+            case OrgNodeKind::Manager:
+                std::cout << "Manager: " << name() << "\n";
+                for (std::size_t i = 0; i < childCount(); ++i) {
+                    child(i).showDetails();
+                }
+                break;
+            }
+        }
+    };
+
+    explicit MappedOrgTree(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps the file alive
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + path);
+        }
+        base = static_cast<const char*>(mapping);
+        header = reinterpret_cast<const OrgTreeHeader*>(base);
+        try {
+            validate(path);
+        } catch (...) {
+            ::munmap(const_cast<char*>(base), size);
+            throw;
+        }
+        nodes = reinterpret_cast<const OrgTreeNode*>(base + header->nodesOffset);
+        strings = base + header->stringsOffset;
+    }
+
+    MappedOrgTree(const MappedOrgTree&) = delete;
+    MappedOrgTree& operator=(const MappedOrgTree&) = delete;
+
+    ~MappedOrgTree() {
+        ::munmap(const_cast<char*>(base), size);
+    }
+
+    std::size_t nodeCount() const { return header->nodeCount; }
+    Node node(std::size_t index) const { return Node(this, at(index)); }
+    Node root() const { return node(0); }
 };
 
+// Builds a synthetic org with the given fan-out, object by object, for benchmarking.
+// A quarter of each team are managers, so the tree stays shallow; a chain of managers
+// would overflow the stack when the destructors recurse down it.
+std::shared_ptr<Manager> buildLargeOrg(std::size_t nodeCount, std::size_t fanOut) {
+    auto root = std::make_shared<Manager>("CEO");
+    std::vector<std::shared_ptr<Manager>> managers{root};
+    std::size_t built = 1;
+    for (std::size_t m = 0; built < nodeCount; ++m) {
+        for (std::size_t i = 0; i < fanOut && built < nodeCount; ++i, ++built) {
+            if (i % 4 == 0) {
+                auto lead = std::make_shared<Manager>("Manager " + std::to_string(built));
+                managers[m]->addEmployee(lead);
+                managers.push_back(lead);
+            } else if (i % 4 == 2) {
+                managers[m]->addEmployee(std::make_shared<Designer>("Designer " + std::to_string(built), "UX Designer"));
+            } else {
+                managers[m]->addEmployee(std::make_shared<Developer>("Developer " + std::to_string(built), "Backend Developer"));
+            }
+        }
+    }
+    return root;
+}
+
 int main() {
     // Create leaf nodes
     auto dev1 = std::make_shared<Developer>("Alice", "Frontend Developer");
@@ -108,6 +424,40 @@ int main() {
     // Show details of the entire hierarchy
     generalManager->showDetails();
 
+    // Save the hierarchy and walk it straight from the memory-mapped file
+    OrgTreeWriter writer;
+    writer.save(*generalManager, "org.bin");
+    MappedOrgTree mapped("org.bin");
+    mapped.root().showDetails();
+    std::remove("org.bin"); // The mapping stays valid after the file is unlinked
+
+    // Benchmark: rebuilding a large org object by object vs. mapping the saved image
+    using Clock = std::chrono::steady_clock;
+    const std::size_t nodeCount = 10'000'000;
+
+    auto start = Clock::now();
+    auto largeOrg = buildLargeOrg(nodeCount, 16);
+    auto buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    writer.save(*largeOrg, "large_org.bin");
+    largeOrg.reset();
+
+    start = Clock::now();
+    MappedOrgTree largeMapped("large_org.bin");
+    auto mapMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    std::size_t managers = 0;
+    for (std::size_t i = 0; i < largeMapped.nodeCount(); ++i) {
+        managers += largeMapped.node(i).kind() == OrgNodeKind::Manager;
+    }
+    auto scanMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << "Built " << nodeCount << " employees in " << buildMs << " ms\n";
+    std::cout << "Mapped " << largeMapped.nodeCount() << " employees in " << mapMs
+              << " ms, scanned " << managers << " managers in " << scanMs << " ms\n";
+    std::remove("large_org.bin");
+
     return 0;
 }
 
@@ -117,6 +467,13 @@ int main() {
 //Developer: Alice, Position: Frontend Developer
 //Developer: Bob, Position: Backend Developer
 //Designer: Charlie, Position: UX Designer
+//Manager: General Manager
+//Manager: Team Lead
+//Developer: Alice, Position: Frontend Developer
+//Developer: Bob, Position: Backend Developer
+//Designer: Charlie, Position: UX Designer
+//Built 10000000 employees in ... ms
+//Mapped 10000000 employees in ... ms, scanned ... managers in ... ms
 
 
 //Key Features of the Composite Pattern
@@ -138,3 +495,5 @@ int main() {
 //Introducing composite structures can add complexity, especially if the hierarchy is not needed.
 //Type Safety:
 //Treating leaves and composites uniformly may require type checks or downcasting in some cases.
+//Persistence:
+//A pointer-based tree has to be rebuilt node by node on load. Flattening it into an offset-based image (like the ORGT format above) lets it be memory-mapped and used immediately.
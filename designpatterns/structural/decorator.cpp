@@ -23,41 +23,160 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+// Flat view of a decorated coffee: base product plus its add-ons in wrapping order
+struct CoffeeRecipe {
+    std::string base;
+    std::vector<std::string> ingredients;
+    double cost = 0.0;
+    std::string description;
+
+    void addIngredient(std::string_view name, double price) {
+        ingredients.emplace_back(name);
+        cost += price;
+        description += ", ";
+        description += name;
+    }
+};
 
 // Base Component
 class Coffee {
 public:
     virtual std::string getDescription() const = 0;
     virtual double getCost() const = 0;
+
+    // Appends this coffee to a recipe. Unknown coffees are treated as an opaque base.
+    virtual void addToRecipe(CoffeeRecipe& recipe) const {
+        recipe.base = getDescription();
+        recipe.description = recipe.base;
+        recipe.cost = getCost();
+    }
+
     virtual ~Coffee() = default;
 };
 
 
 class PlainCoffee : public Coffee {
 public:
+    static constexpr std::string_view name = "Plain Coffee";
+    static constexpr double price = 2.0; // Base price of plain coffee
+
     std::string getDescription() const override {
-        return "Plain Coffee";
+        return std::string(name);
     }
 
     double getCost() const override {
-        return 2.0; // Base price of plain coffee
+        return price;
     }
 };
 
+// Add-ons on the menu, shared by the runtime decorators and compile-time compositions
+struct Milk {
+    static constexpr std::string_view name = "Milk";
+    static constexpr double price = 0.5;
+};
+
+struct Sugar {
+    static constexpr std::string_view name = "Sugar";
+    static constexpr double price = 0.2;
+};
+
+struct Caramel {
+    static constexpr std::string_view name = "Caramel";
+    static constexpr double price = 0.7;
+};
+
+
+// Version shared by the decorators of a sealed chain. Rewiring one of them bumps it, so
+// sealed recipes of that chain know to rebuild while other chains are left alone.
+// Splicing one chain into another merges their versions, union-find style. Chains
+// that are never sealed never get one.
+struct ChainVersion {
+    std::uint64_t value = 0;
+    std::shared_ptr<ChainVersion> mergedInto;
+
+    static std::shared_ptr<ChainVersion> find(std::shared_ptr<ChainVersion> version) {
+        while (version->mergedInto) {
+            if (version->mergedInto->mergedInto) {
+                version->mergedInto = version->mergedInto->mergedInto; // Path halving
+            }
+            version = version->mergedInto;
+        }
+        return version;
+    }
+};
 
 class CoffeeDecorator : public Coffee {
+private:
+    std::shared_ptr<Coffee> wrapped; // Composition: wraps a Coffee object
+    mutable std::shared_ptr<ChainVersion> version; // Set once the chain is sealed
+
+    friend class SealedCoffee;
+
+    // Gives every decorator in the chain under coffee a version and returns the root.
+    // A versioned decorator's whole chain is already versioned, so the walk stops at the
+    // first one; its root is merged into root when both exist.
+    static std::shared_ptr<ChainVersion> track(const Coffee* coffee, std::shared_ptr<ChainVersion> root = nullptr) {
+        auto decorator = dynamic_cast<const CoffeeDecorator*>(coffee);
+        const CoffeeDecorator* versioned = decorator;
+        while (versioned && !versioned->version) {
+            versioned = dynamic_cast<const CoffeeDecorator*>(versioned->wrapped.get());
+        }
+        if (versioned) {
+            auto existing = ChainVersion::find(versioned->version);
+            if (!root) {
+                root = existing;
+            } else if (existing != root) {
+                ++existing->value;
+                existing->mergedInto = root;
+            }
+        } else if (!root) {
+            root = std::make_shared<ChainVersion>();
+        }
+        for (; decorator != versioned; decorator = dynamic_cast<const CoffeeDecorator*>(decorator->wrapped.get())) {
+            decorator->version = root;
+        }
+        return root;
+    }
+
 protected:
-    std::shared_ptr<Coffee> coffee; // Composition: wraps a Coffee object
+    const Coffee& coffee() const {
+        return *wrapped;
+    }
 
 public:
-    CoffeeDecorator(std::shared_ptr<Coffee> coffee) : coffee(std::move(coffee)) {}
+    CoffeeDecorator(std::shared_ptr<Coffee> coffee) : wrapped(std::move(coffee)) {}
+
+    void setCoffee(std::shared_ptr<Coffee> newCoffee) {
+        wrapped = std::move(newCoffee);
+        if (version) { // Part of a sealed chain: cover the new inner chain and invalidate
+            auto root = ChainVersion::find(version);
+            track(wrapped.get(), root);
+            ++root->value;
+        }
+    }
 
     std::string getDescription() const override {
-        return coffee->getDescription();
+        return wrapped->getDescription();
     }
 
     double getCost() const override {
-        return coffee->getCost();
+        return wrapped->getCost();
+    }
+
+    void addToRecipe(CoffeeRecipe& recipe) const override {
+        wrapped->addToRecipe(recipe);
     }
 };
 
@@ -66,11 +185,16 @@ public:
     MilkDecorator(std::shared_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
 
     std::string getDescription() const override {
-        return coffee->getDescription() + ", Milk";
+        return coffee().getDescription() + ", Milk";
     }
 
     double getCost() const override {
-        return coffee->getCost() + 0.5; // Add cost of milk
+        return coffee().getCost() + Milk::price; // Add cost of milk
+    }
+
+    void addToRecipe(CoffeeRecipe& recipe) const override {
+        coffee().addToRecipe(recipe);
+        recipe.addIngredient(Milk::name, Milk::price);
     }
 };
 
@@ -79,11 +203,16 @@ public:
     SugarDecorator(std::shared_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
 
     std::string getDescription() const override {
-        return coffee->getDescription() + ", Sugar";
+        return coffee().getDescription() + ", Sugar";
     }
 
     double getCost() const override {
-        return coffee->getCost() + 0.2; // Add cost of sugar
+        return coffee().getCost() + Sugar::price; // Add cost of sugar
+    }
+
+    void addToRecipe(CoffeeRecipe& recipe) const override {
+        coffee().addToRecipe(recipe);
+        recipe.addIngredient(Sugar::name, Sugar::price);
     }
 };
 
@@ -92,14 +221,320 @@ public:
     CaramelDecorator(std::shared_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
 
     std::string getDescription() const override {
-        return coffee->getDescription() + ", Caramel";
+        return coffee().getDescription() + ", Caramel";
+    }
+
+    double getCost() const override {
+        return coffee().getCost() + Caramel::price; // Add cost of caramel
+    }
+
+    void addToRecipe(CoffeeRecipe& recipe) const override {
+        coffee().addToRecipe(recipe);
+        recipe.addIngredient(Caramel::name, Caramel::price);
+    }
+};
+
+// Sealed Decorator Chain
+// Walks a decorator stack once and keeps the result as a flat recipe. Cost and
+// description are then answered without recursing or rebuilding strings. If any
+// decorator is rewired afterwards, the recipe is rebuilt on the next call.
+// Not thread-safe: reseal from one thread, or seal before sharing.
+class SealedCoffee final : public Coffee {
+private:
+    std::shared_ptr<Coffee> chain;
+    const CoffeeDecorator* top = nullptr; // Null when the chain is a bare component
+    mutable CoffeeRecipe recipe;
+    mutable std::shared_ptr<ChainVersion> sealedRoot;
+    mutable std::uint64_t sealedVersion = 0;
+
+    const CoffeeRecipe& current() const {
+        if (top && (sealedRoot->mergedInto || sealedRoot->value != sealedVersion)) {
+            reseal();
+        }
+        return recipe;
+    }
+
+    void reseal() const {
+        recipe = CoffeeRecipe{};
+        chain->addToRecipe(recipe);
+        if (top) {
+            sealedRoot = CoffeeDecorator::track(top);
+            sealedVersion = sealedRoot->value;
+        }
+    }
+
+public:
+    explicit SealedCoffee(std::shared_ptr<Coffee> coffee)
+        : chain(std::move(coffee)), top(dynamic_cast<const CoffeeDecorator*>(chain.get())) {
+        reseal();
+    }
+
+    const std::string& description() const {
+        return current().description;
+    }
+
+    const std::vector<std::string>& ingredients() const {
+        return current().ingredients;
+    }
+
+    // The Coffee interface returns by value; callers that know they hold a
+    // SealedCoffee should use description() to skip the copy.
+    std::string getDescription() const override {
+        return current().description;
     }
 
     double getCost() const override {
-        return coffee->getCost() + 0.7; // Add cost of caramel
+        return current().cost;
+    }
+
+    void addToRecipe(CoffeeRecipe& out) const override {
+        const CoffeeRecipe& flat = current();
+        out.base = flat.base;
+        out.description = flat.description;
+        out.cost = flat.cost;
+        out.ingredients = flat.ingredients;
     }
 };
 
+// Compile-Time Decorator Composition
+// For fixed menu items the stack is known up front, so it can be composed as a type:
+// Decorated<PlainCoffee, Milk, Sugar> has no heap allocations, no refcounts and no
+// inner virtual calls. Its cost folds to a constant and its description is a static
+// string, yet it is still a Coffee and can be passed anywhere a Coffee is expected.
+template <typename Base, typename... AddOns>
+class Decorated final : public Coffee {
+private:
+    static constexpr std::size_t descriptionLength =
+        Base::name.size() + (std::size_t{0} + ... + (2 + AddOns::name.size()));
+
+    static constexpr std::array<char, descriptionLength + 1> descriptionText = [] {
+        std::array<char, descriptionLength + 1> text{};
+        std::size_t pos = 0;
+        auto append = [&](std::string_view part) {
+            for (char c : part) {
+                text[pos++] = c;
+            }
+        };
+        append(Base::name);
+        ((append(", "), append(AddOns::name)), ...);
+        return text;
+    }();
+
+public:
+    static constexpr double cost = Base::price + (0.0 + ... + AddOns::price);
+    static constexpr std::string_view description{descriptionText.data(), descriptionLength};
+
+    std::string getDescription() const override {
+        return std::string(description);
+    }
+
+    double getCost() const override {
+        return cost;
+    }
+
+    void addToRecipe(CoffeeRecipe& recipe) const override {
+        recipe.base = std::string(Base::name);
+        recipe.description = std::string(Base::name);
+        recipe.cost = Base::price;
+        (recipe.addIngredient(AddOns::name, AddOns::price), ...);
+    }
+};
+
+using Latte = Decorated<PlainCoffee, Milk>;
+using SweetLatte = Decorated<PlainCoffee, Milk, Sugar>;
+using CaramelMacchiato = Decorated<PlainCoffee, Milk, Sugar, Caramel>;
+
+static_assert(CaramelMacchiato::description == "Plain Coffee, Milk, Sugar, Caramel");
+
+// Bulk Pricing
+// Pricing millions of orders through object chains is dominated by allocation and
+// pointer chasing. Here an order is just a base product plus a count per add-on
+// (4 bytes). Orders are priced a block at a time: counts are transposed into
+// columns and each column is a multiply-add loop the compiler vectorizes (SSE/AVX
+// or NEON, depending on the target). Prices come from the same constants the
+// decorator classes use, so both paths always agree.
+enum AddOnIndex : std::size_t {
+    kMilkIndex,
+    kSugarIndex,
+    kCaramelIndex,
+    kAddOnCount
+};
+
+enum BaseProductIndex : std::uint8_t {
+    kPlainCoffeeIndex,
+    kBaseProductCount
+};
+
+struct CoffeeOrder {
+    std::uint8_t base = kPlainCoffeeIndex;
+    std::array<std::uint8_t, kAddOnCount> addOns{}; // How many of each add-on
+};
+
+static_assert(sizeof(CoffeeOrder) == 4, "CoffeeOrder is also the on-disk record");
+
+struct PriceTable {
+    std::array<double, kBaseProductCount> basePrices;
+    std::array<double, kAddOnCount> addOnPrices;
+    std::array<std::string_view, kAddOnCount> addOnNames;
+};
+
+inline constexpr PriceTable kMenuPrices{
+    {PlainCoffee::price},
+    {Milk::price, Sugar::price, Caramel::price},
+    {Milk::name, Sugar::name, Caramel::name},
+};
+
+// Encodes a decorated coffee as a compact order
+CoffeeOrder encodeOrder(const Coffee& coffee) {
+    CoffeeRecipe recipe;
+    coffee.addToRecipe(recipe);
+    if (recipe.base != PlainCoffee::name) {
+        throw std::invalid_argument("Unknown base product: " + recipe.base);
+    }
+    CoffeeOrder order;
+    for (const auto& ingredient : recipe.ingredients) {
+        std::size_t index = 0;
+        while (index < kAddOnCount && kMenuPrices.addOnNames[index] != ingredient) {
+            ++index;
+        }
+        if (index == kAddOnCount) {
+            throw std::invalid_argument("Unknown add-on: " + ingredient);
+        }
+        if (order.addOns[index] == UINT8_MAX) {
+            throw std::out_of_range("Too many " + ingredient + " in one order");
+        }
+        ++order.addOns[index];
+    }
+    return order;
+}
+
+class BulkPricer {
+private:
+    static constexpr std::size_t kBlock = 1024;    // Orders priced per SIMD batch
+    static constexpr std::size_t kChunk = 1 << 16; // Orders read per chunk when streaming
+
+    PriceTable table;
+
+public:
+    explicit BulkPricer(const PriceTable& table = kMenuPrices) : table(table) {}
+
+    // Prices count orders into prices[0..count)
+    void price(const CoffeeOrder* orders, std::size_t count, double* prices) const {
+        std::array<std::uint8_t, kBlock> column;
+        for (std::size_t begin = 0; begin < count; begin += kBlock) {
+            const std::size_t n = std::min(kBlock, count - begin);
+            const CoffeeOrder* block = orders + begin;
+            double* out = prices + begin;
+
+            std::uint8_t maxBase = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                maxBase = std::max(maxBase, block[i].base);
+            }
+            if (maxBase >= kBaseProductCount) {
+                throw std::out_of_range("Order references an unknown base product");
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = table.basePrices[block[i].base];
+            }
+
+            for (std::size_t a = 0; a < kAddOnCount; ++a) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    column[i] = block[i].addOns[a];
+                }
+                const double unit = table.addOnPrices[a];
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] += column[i] * unit;
+                }
+            }
+        }
+    }
+
+    // Streams an order file (raw CoffeeOrder records) and hands each priced chunk to
+    // sink(const CoffeeOrder*, const double*, std::size_t). Returns the orders priced.
+    template <typename Sink>
+    std::size_t priceFile(const std::string& path, Sink&& sink) const {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        std::vector<CoffeeOrder> orders(kChunk);
+        std::vector<double> prices(kChunk);
+        std::size_t total = 0;
+        while (in) {
+            in.read(reinterpret_cast<char*>(orders.data()),
+                    static_cast<std::streamsize>(orders.size() * sizeof(CoffeeOrder)));
+            auto bytes = static_cast<std::size_t>(in.gcount());
+            if (bytes % sizeof(CoffeeOrder) != 0) {
+                throw std::runtime_error(path + ": truncated order record");
+            }
+            std::size_t count = bytes / sizeof(CoffeeOrder);
+            if (count == 0) {
+                break;
+            }
+            price(orders.data(), count, prices.data());
+            sink(orders.data(), prices.data(), count);
+            total += count;
+        }
+        return total;
+    }
+};
+
+// Generates random orders with up to three of each add-on
+std::vector<CoffeeOrder> makeRandomOrders(std::size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> amount(0, 3);
+    std::vector<CoffeeOrder> orders(count);
+    for (auto& order : orders) {
+        for (auto& addOn : order.addOns) {
+            addOn = static_cast<std::uint8_t>(amount(rng));
+        }
+    }
+    return orders;
+}
+
+// Builds the decorator chain an order describes
+std::shared_ptr<Coffee> makeCoffee(const CoffeeOrder& order) {
+    std::shared_ptr<Coffee> coffee = std::make_shared<PlainCoffee>();
+    for (int i = 0; i < order.addOns[kMilkIndex]; ++i) coffee = std::make_shared<MilkDecorator>(coffee);
+    for (int i = 0; i < order.addOns[kSugarIndex]; ++i) coffee = std::make_shared<SugarDecorator>(coffee);
+    for (int i = 0; i < order.addOns[kCaramelIndex]; ++i) coffee = std::make_shared<CaramelDecorator>(coffee);
+    return coffee;
+}
+
+// Builds a chain of the given depth cycling through milk, sugar and caramel
+std::shared_ptr<Coffee> makeChain(int depth) {
+    std::shared_ptr<Coffee> coffee = std::make_shared<PlainCoffee>();
+    for (int i = 0; i < depth; ++i) {
+        switch (i % 3) {
+        case 0: coffee = std::make_shared<MilkDecorator>(coffee); break;
+        case 1: coffee = std::make_shared<SugarDecorator>(coffee); break;
+        default: coffee = std::make_shared<CaramelDecorator>(coffee); break;
+        }
+    }
+    return coffee;
+}
+
+// Keeps benchmark results observable so the optimizer cannot drop the loops
+volatile std::size_t benchmarkSink = 0;
+
+// Sealed coffees hand out their cached description without copying it
+std::string describe(const Coffee& coffee) { return coffee.getDescription(); }
+const std::string& describe(const SealedCoffee& coffee) { return coffee.description(); }
+
+// Times describe() + getCost() on a coffee, returning nanoseconds per call pair
+template <typename C>
+double timeCoffee(const C& coffee, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t sink = 0;
+    for (int i = 0; i < iterations; ++i) {
+        sink += describe(coffee).size();
+        sink += static_cast<std::size_t>(coffee.getCost());
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    benchmarkSink = sink;
+    return elapsed / iterations;
+}
+
 int main() {
     // Start with plain coffee
     std::shared_ptr<Coffee> myCoffee = std::make_shared<PlainCoffee>();
@@ -117,6 +552,101 @@ int main() {
     myCoffee = std::make_shared<CaramelDecorator>(myCoffee);
     std::cout << myCoffee->getDescription() << " costs $" << myCoffee->getCost() << "\n";
 
+    // Seal the stack into a flat recipe
+    SealedCoffee sealed(myCoffee);
+    std::cout << "Sealed: " << sealed.description() << " costs $" << sealed.getCost() << "\n";
+
+    // Rewiring a decorator invalidates the sealed recipe
+    auto decaf = std::make_shared<CaramelDecorator>(std::make_shared<PlainCoffee>());
+    decaf->setCoffee(std::make_shared<MilkDecorator>(std::make_shared<PlainCoffee>()));
+    SealedCoffee sealedDecaf(decaf);
+    decaf->setCoffee(std::make_shared<PlainCoffee>());
+    std::cout << "Resealed: " << sealedDecaf.description() << " costs $" << sealedDecaf.getCost() << "\n";
+
+    // Compile-time compositions are still Coffees
+    std::shared_ptr<Coffee> macchiato = std::make_shared<CaramelMacchiato>();
+    std::cout << "Menu: " << macchiato->getDescription() << " costs $" << macchiato->getCost() << "\n";
+    std::cout << "Menu: " << SweetLatte::description << " costs $" << SweetLatte::cost << "\n";
+
+    // Benchmark: building and pricing a runtime shared_ptr chain vs. a compile-time composition
+    const int orders = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    double runtimeTotal = 0.0;
+    for (int i = 0; i < orders; ++i) {
+        std::shared_ptr<Coffee> order = std::make_shared<CaramelDecorator>(
+            std::make_shared<SugarDecorator>(std::make_shared<MilkDecorator>(std::make_shared<PlainCoffee>())));
+        runtimeTotal += order->getCost();
+    }
+    auto runtimeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    double composedTotal = 0.0;
+    for (int i = 0; i < orders; ++i) {
+        CaramelMacchiato order;
+        const Coffee& asCoffee = order;
+        composedTotal += asCoffee.getCost();
+    }
+    auto composedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    benchmarkSink = static_cast<std::size_t>(runtimeTotal + composedTotal);
+
+    std::cout << "Runtime chain: " << runtimeNs / orders << " ns/order, compile-time: "
+              << composedNs / orders << " ns/order\n";
+
+    // Bulk pricing agrees with the decorator chain
+    BulkPricer pricer;
+    CoffeeOrder encoded = encodeOrder(*myCoffee);
+    double bulkPrice = 0.0;
+    pricer.price(&encoded, 1, &bulkPrice);
+    std::cout << "Bulk: " << myCoffee->getDescription() << " costs $" << bulkPrice << "\n";
+
+    // Benchmark: object chain per order vs. bulk pricing vs. streaming from a file
+    const std::size_t batchSize = 2'000'000;
+    auto batch = makeRandomOrders(batchSize);
+    std::vector<double> prices(batchSize);
+
+    start = std::chrono::steady_clock::now();
+    double chainTotal = 0.0;
+    for (const auto& order : batch) {
+        chainTotal += makeCoffee(order)->getCost();
+    }
+    double chainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    pricer.price(batch.data(), batch.size(), prices.data());
+    double bulkSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double bulkTotal = 0.0;
+    for (double p : prices) {
+        bulkTotal += p;
+    }
+
+    {
+        std::ofstream orderFile("orders.bin", std::ios::binary | std::ios::trunc);
+        orderFile.write(reinterpret_cast<const char*>(batch.data()),
+                        static_cast<std::streamsize>(batch.size() * sizeof(CoffeeOrder)));
+    }
+    start = std::chrono::steady_clock::now();
+    double streamedTotal = 0.0;
+    pricer.priceFile("orders.bin", [&](const CoffeeOrder*, const double* chunk, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            streamedTotal += chunk[i];
+        }
+    });
+    std::remove("orders.bin");
+    double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Object chains: " << batchSize / chainSeconds << " orders/sec, bulk: "
+              << batchSize / bulkSeconds << " orders/sec, streamed: " << batchSize / streamSeconds
+              << " orders/sec (totals " << chainTotal << " / " << bulkTotal << " / " << streamedTotal << ")\n";
+
+    // Benchmark: recursive decorator chain vs. sealed recipe
+    const int iterations = 20000;
+    for (int depth : {1, 2, 4, 8, 16, 32, 64}) {
+        auto chain = makeChain(depth);
+        SealedCoffee flat(chain);
+        std::cout << "Depth " << depth << ": recursive " << timeCoffee(*chain, iterations)
+                  << " ns, sealed " << timeCoffee(flat, iterations) << " ns\n";
+    }
+
     return 0;
 }
 
@@ -124,6 +654,16 @@ int main() {
 //Plain Coffee, Milk costs $2.5
 //Plain Coffee, Milk, Sugar costs $2.7
 //Plain Coffee, Milk, Sugar, Caramel costs $3.4
+//Sealed: Plain Coffee, Milk, Sugar, Caramel costs $3.4
+//Resealed: Plain Coffee, Caramel costs $2.7
+//Menu: Plain Coffee, Milk, Sugar, Caramel costs $3.4
+//Menu: Plain Coffee, Milk, Sugar costs $2.7
+//Runtime chain: ... ns/order, compile-time: ... ns/order
+//Bulk: Plain Coffee, Milk, Sugar, Caramel costs $3.4
+//Object chains: ... orders/sec, bulk: ... orders/sec, streamed: ... orders/sec (totals ...)
+//Depth 1: recursive ... ns, sealed ... ns
+//...
+//Depth 64: recursive ... ns, sealed ... ns
 
 
 //Key Benefits
@@ -133,3 +673,4 @@ int main() {
 //Caveats
 //Complexity: Too many decorators can make the code harder to understand.
 //Overhead: Wrapping objects can introduce runtime overhead.
+//Sealing: Every call walks the whole chain and string-building decorators allocate at each level; a SealedCoffee flattens a finished stack once and rebuilds only when that chain is rewired.
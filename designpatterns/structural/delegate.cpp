@@ -25,6 +25,28 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <cctype>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 // Delegate Interface
 class PrintStrategy {
@@ -49,24 +71,895 @@ public:
     }
 };
 
+// Asynchronous File Delegate
+// Callers only append to an in-memory staging buffer. A background writer thread
+// swaps the staging buffer with its own (double buffering) and writes the whole
+// batch with one large write() call, so printing never waits on the disk.
+struct FilePrintOptions {
+    std::size_t flushBytes = 1 << 20;              // Wake the writer once this much text is staged
+    std::chrono::milliseconds flushInterval{100};  // Longest time text may sit in the staging buffer; 0 = no timed flush
+    std::size_t maxStagedBytes = 64 << 20;         // Callers wait beyond this (backpressure)
+    std::size_t fsyncBytes = 0;                    // fsync after this many bytes written; 0 = never
+    std::chrono::milliseconds fsyncInterval{0};    // fsync at most this often; 0 = never
+};
+
+class AsyncFilePrint : public PrintStrategy {
+private:
+    FilePrintOptions options;
+    int fd = -1;
+
+    std::mutex mutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable drained;
+    std::string staging;          // Filled by callers
+    std::string writing;          // Owned by the writer thread while unlocked
+    std::uint64_t stagedBytes = 0;  // Total bytes ever staged
+    std::uint64_t writtenBytes = 0; // Total bytes handed to the kernel
+    bool flushRequested = false;
+    bool stopping = false;
+    std::error_code writeError;
+    std::thread writer;
+
+    void writeAll(const std::string& data) {
+        const char* cursor = data.data();
+        std::size_t left = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd, cursor, left);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "AsyncFilePrint write");
+            }
+            cursor += n;
+            left -= static_cast<std::size_t>(n);
+        }
+    }
+
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        std::uint64_t unsyncedBytes = 0;
+        auto lastSync = Clock::now();
+
+        // An idle writer sleeps until text arrives; the flush timer only runs while
+        // something is staged
+        bool timed = options.flushInterval.count() > 0;
+        auto ready = [&] { return stopping || flushRequested || staging.size() >= options.flushBytes; };
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (timed && !staging.empty()) {
+                wakeWriter.wait_for(lock, options.flushInterval, ready);
+            } else {
+                wakeWriter.wait(lock, [&] { return ready() || (timed && !staging.empty()); });
+                if (!ready()) {
+                    continue; // First text staged: start the flush timer
+                }
+            }
+            if (staging.empty()) {
+                flushRequested = false;
+                drained.notify_all();
+                if (stopping) {
+                    break;
+                }
+                continue;
+            }
+
+            std::swap(staging, writing);
+            flushRequested = false;
+            drained.notify_all(); // Staging space was freed
+            lock.unlock();
+
+            std::error_code error;
+            try {
+                writeAll(writing);
+                unsyncedBytes += writing.size();
+                bool syncBySize = options.fsyncBytes > 0 && unsyncedBytes >= options.fsyncBytes;
+                bool syncByTime = options.fsyncInterval.count() > 0 &&
+                                  Clock::now() - lastSync >= options.fsyncInterval;
+                if (syncBySize || syncByTime) {
+                    if (::fsync(fd) != 0) {
+                        throw std::system_error(errno, std::generic_category(), "AsyncFilePrint fsync");
+                    }
+                    unsyncedBytes = 0;
+                    lastSync = Clock::now();
+                }
+            } catch (const std::system_error& e) {
+                error = e.code();
+            }
+            std::size_t batch = writing.size();
+            writing.clear(); // Keeps capacity for the next swap
+
+            lock.lock();
+            writtenBytes += batch;
+            if (error && !writeError) {
+                writeError = error;
+            }
+            drained.notify_all();
+        }
+    }
+
+public:
+    explicit AsyncFilePrint(const std::string& path, FilePrintOptions options = {})
+        : options(options) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+        }
+        staging.reserve(options.flushBytes * 2);
+        writing.reserve(options.flushBytes * 2);
+        writer = std::thread([this] { run(); });
+    }
+
+    AsyncFilePrint(const AsyncFilePrint&) = delete;
+    AsyncFilePrint& operator=(const AsyncFilePrint&) = delete;
+
+    // Errors from the final write and fsync are lost; call close() to see them
+    ~AsyncFilePrint() override {
+        try {
+            close();
+        } catch (const std::system_error&) {
+        }
+    }
+
+    // Writes everything printed so far, stops the writer and closes the file; throws
+    // the first write or fsync error, including any the writer hit earlier. Nothing
+    // may print after this.
+    void close() {
+        if (fd < 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWriter.notify_one();
+        writer.join();
+        if ((options.fsyncBytes > 0 || options.fsyncInterval.count() > 0) && ::fsync(fd) != 0 && !writeError) {
+            writeError = std::error_code(errno, std::generic_category());
+        }
+        ::close(fd);
+        fd = -1;
+        if (writeError) {
+            throw std::system_error(writeError, "AsyncFilePrint close");
+        }
+    }
+
+    void print(const std::string& text) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (staging.size() >= options.maxStagedBytes) {
+            drained.wait(lock, [&] { return staging.size() < options.maxStagedBytes; });
+        }
+        bool wasEmpty = staging.empty();
+        bool wasBelow = staging.size() < options.flushBytes;
+        staging += text;
+        staging += '\n';
+        stagedBytes += text.size() + 1;
+        if ((wasEmpty && options.flushInterval.count() > 0) ||
+            (wasBelow && staging.size() >= options.flushBytes)) {
+            wakeWriter.notify_one();
+        }
+    }
+
+    // Blocks until everything printed so far has been written; rethrows the first
+    // write or fsync error the writer hit
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::uint64_t target = stagedBytes;
+        flushRequested = true;
+        wakeWriter.notify_one();
+        drained.wait(lock, [&] { return writtenBytes >= target || writeError; });
+        if (writeError) {
+            throw std::system_error(writeError, "AsyncFilePrint flush");
+        }
+    }
+
+    // Flushes and then forces the data to stable storage
+    void sync() {
+        flush();
+        if (::fsync(fd) != 0) {
+            throw std::system_error(errno, std::generic_category(), "AsyncFilePrint fsync");
+        }
+    }
+};
+
+// Hazard Pointers
+// Lets readers use a shared object without locks or refcounts. A reader publishes the
+// pointer it is about to use in its own hazard slot; a writer that has unlinked an
+// object only deletes it once no slot holds it anymore.
+class HazardDomain {
+public:
+    static constexpr std::size_t kMaxThreads = 256;
+    static constexpr std::size_t kSlotsPerThread = 4; // Nesting depth of protected reads
+
+    struct alignas(64) Record {
+        std::atomic<bool> owned{false};
+        std::atomic<const void*> hazards[kSlotsPerThread] = {};
+    };
+
+private:
+    Record records[kMaxThreads];
+    // High-water mark, bounds the scan. Raised and read seq_cst, in the same total
+    // order as the hazard stores and the writer's unlink, so a scan that started after
+    // an unlink cannot miss a record whose hazard was published before it.
+    std::atomic<std::size_t> recordsInUse{0};
+
+public:
+    static HazardDomain& instance() {
+        static HazardDomain domain;
+        return domain;
+    }
+
+    Record& acquire() {
+        for (std::size_t i = 0; i < kMaxThreads; ++i) {
+            bool expected = false;
+            if (!records[i].owned.load(std::memory_order_relaxed) &&
+                records[i].owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                std::size_t inUse = recordsInUse.load(std::memory_order_relaxed);
+                while (inUse < i + 1 &&
+                       !recordsInUse.compare_exchange_weak(inUse, i + 1, std::memory_order_seq_cst)) {
+                }
+                return records[i];
+            }
+        }
+        throw std::runtime_error("HazardDomain: more than " + std::to_string(kMaxThreads) + " threads");
+    }
+
+    void release(Record& record) {
+        record.owned.store(false, std::memory_order_release);
+    }
+
+    bool isProtected(const void* pointer) const {
+        std::size_t inUse = recordsInUse.load(std::memory_order_seq_cst);
+        for (std::size_t i = 0; i < inUse; ++i) {
+            for (const auto& hazard : records[i].hazards) {
+                if (hazard.load(std::memory_order_seq_cst) == pointer) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+// Owns the calling thread's hazard record for the thread's lifetime
+struct ThreadHazards {
+    HazardDomain::Record& record = HazardDomain::instance().acquire();
+    std::size_t depth = 0;
+
+    ~ThreadHazards() {
+        HazardDomain::instance().release(record);
+    }
+
+    static ThreadHazards& current() {
+        thread_local ThreadHazards hazards;
+        return hazards;
+    }
+};
+
+// Protects one pointer for the guard's scope
+class HazardGuard {
+private:
+    ThreadHazards& thread = ThreadHazards::current();
+    std::atomic<const void*>& slot = claim(thread);
+
+    // Checks the depth before indexing, so an over-deep guard never touches a slot
+    static std::atomic<const void*>& claim(ThreadHazards& thread) {
+        if (thread.depth == HazardDomain::kSlotsPerThread) {
+            throw std::runtime_error("HazardGuard: nested too deeply");
+        }
+        return thread.record.hazards[thread.depth++];
+    }
+
+public:
+    HazardGuard() = default;
+
+    HazardGuard(const HazardGuard&) = delete;
+    HazardGuard& operator=(const HazardGuard&) = delete;
+
+    ~HazardGuard() {
+        slot.store(nullptr, std::memory_order_release);
+        --thread.depth;
+    }
+
+    // Loads source and keeps the result alive until the guard is destroyed
+    template <typename T>
+    T* protect(const std::atomic<T*>& source) {
+        T* pointer = source.load(std::memory_order_acquire);
+        while (true) {
+            slot.store(pointer, std::memory_order_seq_cst);
+            T* again = source.load(std::memory_order_seq_cst);
+            if (again == pointer) {
+                return pointer;
+            }
+            pointer = again;
+        }
+    }
+};
+
+// Hot-Swappable Delegate
+// Holds a delegate by value in a node that can be replaced while other threads call
+// through it. Setting one costs a single node allocation, which the swap needs; calls
+// take no lock and touch no refcount. Replaced nodes are released once the last
+// in-flight call that could see them has returned.
+template <typename Delegate>
+class HotSwapDelegate {
+private:
+    // How long a swap keeps retrying reclaim before leaving nodes readers still hold
+    static constexpr std::chrono::microseconds kReclaimBudget{50};
+
+    struct Node {
+        Delegate delegate;
+    };
+
+    std::atomic<Node*> current{nullptr};
+    std::mutex retiredMutex; // Only taken by swappers
+    std::vector<Node*> retired;
+
+    void reclaim() {
+        auto& domain = HazardDomain::instance();
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [&](Node* node) {
+            if (domain.isProtected(node)) {
+                return false;
+            }
+            delete node;
+            return true;
+        }), retired.end());
+    }
+
+    // Swaps in the new node and briefly retries reclaim while in-flight calls leave
+    // the old one, so a replaced delegate (and any file or thread it owns) is normally
+    // released here. Nodes a descheduled reader still holds are left for the next
+    // swap, retiredCount() or the destructor.
+    void replace(Node* node) {
+        Node* old = current.exchange(node, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        if (old) {
+            retired.push_back(old);
+        }
+        reclaim();
+        auto deadline = std::chrono::steady_clock::now() + kReclaimBudget;
+        while (!retired.empty() && std::chrono::steady_clock::now() < deadline) {
+            reclaim();
+        }
+    }
+
+public:
+    HotSwapDelegate() = default;
+    HotSwapDelegate(const HotSwapDelegate&) = delete;
+    HotSwapDelegate& operator=(const HotSwapDelegate&) = delete;
+
+    // Must not race with calls: there can be no readers left when the holder dies
+    ~HotSwapDelegate() {
+        delete current.load(std::memory_order_acquire);
+        for (Node* node : retired) {
+            delete node;
+        }
+    }
+
+    // Replaces the delegate; the one it replaces is released as described at replace()
+    void store(Delegate delegate) {
+        replace(new Node{std::move(delegate)});
+    }
+
+    // Removes the delegate; later calls find nothing to call
+    void clear() {
+        replace(nullptr);
+    }
+
+    // Calls f(delegate) if one is set; returns whether it was called
+    template <typename F>
+    bool with(F&& f) const {
+        HazardGuard guard;
+        Node* node = guard.protect(current);
+        if (!node) {
+            return false;
+        }
+        f(node->delegate);
+        return true;
+    }
+
+    // Releases whatever no call still holds, then counts what is left
+    std::size_t retiredCount() {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        reclaim();
+        return retired.size();
+    }
+};
+
+// Inline Type-Erased Delegate
+// Holds any print callable by value in a small inline buffer: lambdas, function
+// pointers, PrintStrategy objects or a shared_ptr<PrintStrategy>. Nothing is heap
+// allocated; a callable that does not fit is rejected at compile time.
+class PrintDelegate {
+public:
+    static constexpr std::size_t kCapacity = 4 * sizeof(void*);
+
+private:
+    enum class Op { Copy, Move, Destroy };
+
+    using Invoker = void (*)(void* object, const std::string& text);
+    using Manager = void (*)(Op op, void* dst, void* src);
+
+    alignas(std::max_align_t) unsigned char storage[kCapacity];
+    Invoker invoker = nullptr;
+    Manager manager = nullptr;
+
+    template <typename T>
+    static void invokeStored(void* object, const std::string& text) {
+        T& target = *static_cast<T*>(object);
+        if constexpr (std::is_base_of_v<PrintStrategy, T>) {
+            target.print(text);
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<PrintStrategy>>) {
+            target->print(text);
+        } else {
+            target(text);
+        }
+    }
+
+    template <typename T>
+    static void manageStored(Op op, void* dst, void* src) {
+        switch (op) {
+        case Op::Copy: ::new (dst) T(*static_cast<const T*>(src)); break;
+        case Op::Move: ::new (dst) T(std::move(*static_cast<T*>(src))); break;
+        case Op::Destroy: static_cast<T*>(dst)->~T(); break;
+        }
+    }
+
+    void reset() {
+        if (manager) {
+            manager(Op::Destroy, storage, nullptr);
+        }
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+public:
+    PrintDelegate() = default;
+
+    template <typename F, typename T = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<T, PrintDelegate>>>
+    PrintDelegate(F&& f) {
+        static_assert(sizeof(T) <= kCapacity, "Callable too large for PrintDelegate's inline buffer");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Callable over-aligned for PrintDelegate");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "PrintDelegate requires noexcept moves");
+        if constexpr ((std::is_pointer_v<T> && !std::is_function_v<std::remove_reference_t<F>>) ||
+                      std::is_same_v<T, std::shared_ptr<PrintStrategy>>) {
+            if (!f) {
+                return; // Null pointers make an empty delegate
+            }
+        }
+        ::new (static_cast<void*>(storage)) T(std::forward<F>(f));
+        invoker = &invokeStored<T>;
+        manager = &manageStored<T>;
+    }
+
+    PrintDelegate(const PrintDelegate& other) : invoker(other.invoker), manager(other.manager) {
+        if (manager) {
+            manager(Op::Copy, storage, const_cast<unsigned char*>(other.storage));
+        }
+    }
+
+    PrintDelegate(PrintDelegate&& other) noexcept : invoker(other.invoker), manager(other.manager) {
+        if (manager) {
+            manager(Op::Move, storage, other.storage);
+            other.reset();
+        }
+    }
+
+    PrintDelegate& operator=(const PrintDelegate& other) {
+        if (this != &other) {
+            PrintDelegate copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    PrintDelegate& operator=(PrintDelegate&& other) noexcept {
+        if (this != &other) {
+            reset();
+            invoker = other.invoker;
+            manager = other.manager;
+            if (manager) {
+                manager(Op::Move, storage, other.storage);
+                other.reset();
+            }
+        }
+        return *this;
+    }
+
+    ~PrintDelegate() {
+        reset();
+    }
+
+    explicit operator bool() const {
+        return invoker != nullptr;
+    }
+
+    // Throws std::bad_function_call if the delegate is empty
+    void operator()(const std::string& text) {
+        if (!invoker) {
+            throw std::bad_function_call();
+        }
+        invoker(storage, text);
+    }
+};
+
 class Printer {
 private:
-    std::shared_ptr<PrintStrategy> strategy; // Reference to a delegate
+    HotSwapDelegate<PrintDelegate> delegate; // Swappable while printing; empty delegates are never stored
 
 public:
     void setPrintStrategy(const std::shared_ptr<PrintStrategy>& newStrategy) {
-        strategy = newStrategy;
+        setPrintDelegate(newStrategy);
     }
 
-    void print(const std::string& text) {
-        if (strategy) {
-            strategy->print(text); // Delegate the task
+    // Any callable PrintDelegate accepts: a lambda, a function or a strategy by value
+    void setPrintDelegate(PrintDelegate newDelegate) {
+        if (newDelegate) {
+            delegate.store(std::move(newDelegate));
         } else {
+            delegate.clear();
+        }
+    }
+
+    void print(const std::string& text) {
+        bool delegated = delegate.with([&](PrintDelegate& target) {
+            target(text); // Delegate the task
+        });
+        if (!delegated) {
             std::cout << "No print strategy set!" << std::endl;
         }
     }
 };
 
+// Non-owning counterpart for callbacks: two pointers, trivially copyable. The callable
+// it refers to must outlive it, so only pass it down the stack. Plain functions are
+// held by their address, which needs no outside storage.
+class PrintCallbackRef {
+private:
+    using Function = void (*)(const std::string& text);
+
+    union Target {
+        void* object;
+        Function function;
+    };
+
+    Target target;
+    void (*invoker)(Target target, const std::string& text);
+
+public:
+    PrintCallbackRef(Function function) {
+        target.function = function;
+        invoker = [](Target target, const std::string& text) { target.function(text); };
+    }
+
+    template <typename F, typename T = std::remove_reference_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, PrintCallbackRef> &&
+                                          !std::is_function_v<T> && !std::is_pointer_v<std::decay_t<F>>>>
+    PrintCallbackRef(F&& f) {
+        target.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+        invoker = [](Target target, const std::string& text) {
+            if constexpr (std::is_base_of_v<PrintStrategy, std::remove_cv_t<T>>) {
+                static_cast<T*>(target.object)->print(text);
+            } else {
+                (*static_cast<T*>(target.object))(text);
+            }
+        };
+    }
+
+    void operator()(const std::string& text) const {
+        invoker(target, text);
+    }
+};
+
+// Example consumer of a non-owning callback
+void printLines(const std::vector<std::string>& lines, PrintCallbackRef callback) {
+    for (const auto& line : lines) {
+        callback(line);
+    }
+}
+
+// A plain function works as a delegate too
+void printUpperCase(const std::string& text) {
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    std::cout << "Upper case: " << upper << std::endl;
+}
+
+// Small Vector
+// Contiguous storage for up to N elements inside the object itself; only grows onto the
+// heap when more are added.
+template <typename T, std::size_t N>
+class SmallVector {
+private:
+    alignas(T) unsigned char inlineStorage[N * sizeof(T)];
+    T* items = reinterpret_cast<T*>(inlineStorage);
+    std::size_t count = 0;
+    std::size_t capacity = N;
+
+    bool onHeap() const {
+        return items != reinterpret_cast<const T*>(inlineStorage);
+    }
+
+    void grow() {
+        std::size_t newCapacity = capacity * 2;
+        T* bigger = static_cast<T*>(::operator new(newCapacity * sizeof(T), std::align_val_t(alignof(T))));
+        for (std::size_t i = 0; i < count; ++i) {
+            ::new (bigger + i) T(std::move(items[i]));
+            items[i].~T();
+        }
+        if (onHeap()) {
+            ::operator delete(items, std::align_val_t(alignof(T)));
+        }
+        items = bigger;
+        capacity = newCapacity;
+    }
+
+public:
+    SmallVector() = default;
+    SmallVector(const SmallVector&) = delete;
+    SmallVector& operator=(const SmallVector&) = delete;
+
+    ~SmallVector() {
+        for (std::size_t i = 0; i < count; ++i) {
+            items[i].~T();
+        }
+        if (onHeap()) {
+            ::operator delete(items, std::align_val_t(alignof(T)));
+        }
+    }
+
+    void push_back(T value) {
+        if (count == capacity) {
+            grow();
+        }
+        ::new (items + count) T(std::move(value));
+        ++count;
+    }
+
+    // Removes the element at index, keeping the order of the rest
+    void erase(std::size_t index) {
+        for (std::size_t i = index + 1; i < count; ++i) {
+            items[i - 1] = std::move(items[i]);
+        }
+        items[--count].~T();
+    }
+
+    std::size_t size() const { return count; }
+    T& operator[](std::size_t i) { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+};
+
+// Multicast Delegate
+// Fans one print out to many handlers (console, file, metrics, ...). Handlers live in a
+// SmallVector, so the first InlineHandlers adds and any remove never allocate, and a
+// dispatch is a single loop over contiguous memory. Dispatches share a reader lock, so
+// they run concurrently with each other and stay safe while another thread adds or
+// removes handlers. A handler must not add or remove handlers on the same multicast.
+template <std::size_t InlineHandlers = 8>
+class MulticastPrint : public PrintStrategy {
+public:
+    using HandlerId = std::uint64_t;
+
+private:
+    struct Handler {
+        PrintDelegate delegate;
+        HandlerId id;
+    };
+
+    mutable std::shared_mutex mutex;
+    SmallVector<Handler, InlineHandlers> handlers;
+    HandlerId nextId = 1;
+
+public:
+    HandlerId add(PrintDelegate delegate) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        HandlerId id = nextId++;
+        handlers.push_back(Handler{std::move(delegate), id});
+        return id;
+    }
+
+    bool remove(HandlerId id) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (std::size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i].id == id) {
+                handlers.erase(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return handlers.size();
+    }
+
+    void operator()(const std::string& text) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (Handler& handler : handlers) {
+            handler.delegate(text);
+        }
+    }
+
+    void print(const std::string& text) override {
+        (*this)(text);
+    }
+};
+
+// Baseline for comparison: opens, appends and closes the file on every call
+class OfstreamFilePrint : public PrintStrategy {
+private:
+    std::string path;
+
+public:
+    explicit OfstreamFilePrint(std::string path) : path(std::move(path)) {}
+
+    void print(const std::string& text) override {
+        std::ofstream out(path, std::ios::app);
+        out << text << '\n';
+    }
+};
+
+// Prints linesPerThread lines from each thread, reporting lines/sec and caller latency
+void benchmarkFilePrint(const char* label, Printer& printer, int threads, int linesPerThread) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::vector<double>> latencies(threads);
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::string line = "thread " + std::to_string(t) + " says hello to the file";
+            latencies[t].reserve(linesPerThread);
+            for (int i = 0; i < linesPerThread; ++i) {
+                auto before = Clock::now();
+                printer.print(line);
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto& perThread : latencies) {
+        all.insert(all.end(), perThread.begin(), perThread.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::cout << label << ": " << all.size() / seconds << " lines/sec, caller p50 "
+              << all[all.size() / 2] << " us, p99 " << all[all.size() * 99 / 100] << " us\n";
+}
+
+// Counts prints per thread without sharing a cache line between threads
+class CountingPrint : public PrintStrategy {
+public:
+    static inline thread_local std::uint64_t prints = 0;
+
+    void print(const std::string&) override {
+        ++prints;
+    }
+};
+
+// Stress: printing threads call through the Printer while one thread keeps swapping delegates
+void benchmarkHotSwap(int printingThreads, std::chrono::milliseconds duration) {
+    Printer printer;
+    printer.setPrintStrategy(std::make_shared<CountingPrint>());
+
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> totalPrints{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < printingThreads; ++t) {
+        threads.emplace_back([&] {
+            const std::string text = "stress";
+            while (running.load(std::memory_order_relaxed)) {
+                printer.print(text);
+            }
+            totalPrints.fetch_add(CountingPrint::prints, std::memory_order_relaxed);
+        });
+    }
+
+    std::uint64_t swaps = 0;
+    std::thread swapper([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            printer.setPrintStrategy(std::make_shared<CountingPrint>());
+            ++swaps;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    std::this_thread::sleep_for(duration);
+    running = false;
+    swapper.join();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // Measured, not nominal: the printing threads run until they see `running` drop
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Hot swap: " << printingThreads << " threads, " << totalPrints / seconds
+              << " prints/sec, " << swaps << " swaps\n";
+}
+
+// Benchmark: construction and invocation of shared_ptr<PrintStrategy>, std::function and PrintDelegate
+void benchmarkDelegates(int iterations) {
+    using Clock = std::chrono::steady_clock;
+    auto nsPer = [&](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    };
+    std::uint64_t a = 0, b = 0, c = 0;
+    auto capture = [&a, &b, &c](const std::string& text) { a += text.size(); ++b; c ^= b; };
+    const std::string text = "benchmark";
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::shared_ptr<PrintStrategy> strategy = std::make_shared<CountingPrint>();
+        strategy->print(text);
+    }
+    double sharedBuild = nsPer(start);
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::function<void(const std::string&)> function = capture;
+        function(text);
+    }
+    double functionBuild = nsPer(start);
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        PrintDelegate delegate = capture;
+        delegate(text);
+    }
+    double delegateBuild = nsPer(start);
+
+    std::shared_ptr<PrintStrategy> strategy = std::make_shared<CountingPrint>();
+    std::function<void(const std::string&)> function = capture;
+    PrintDelegate delegate = capture;
+    PrintCallbackRef callback = capture;
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) strategy->print(text);
+    double sharedCall = nsPer(start);
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) function(text);
+    double functionCall = nsPer(start);
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) delegate(text);
+    double delegateCall = nsPer(start);
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) callback(text);
+    double refCall = nsPer(start);
+
+    std::cout << "Construct+call ns: shared_ptr " << sharedBuild << ", std::function " << functionBuild
+              << ", PrintDelegate " << delegateBuild << "\n";
+    std::cout << "Call ns: shared_ptr " << sharedCall << ", std::function " << functionCall
+              << ", PrintDelegate " << delegateCall << ", PrintCallbackRef " << refCall
+              << " (" << a + b + c + CountingPrint::prints << ")\n";
+}
+
+// Benchmark: dispatch cost with 1, 8 and 64 handlers
+void benchmarkMulticast(int iterations) {
+    for (std::size_t handlerCount : {1, 8, 64}) {
+        MulticastPrint<8> multicast;
+        std::vector<std::uint64_t> counters(handlerCount);
+        for (std::size_t h = 0; h < handlerCount; ++h) {
+            std::uint64_t* counter = &counters[h];
+            multicast.add([counter](const std::string& text) { *counter += text.size(); });
+        }
+        const std::string text = "fan-out";
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            multicast(text);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Multicast to " << handlerCount << " handlers: " << ns / iterations << " ns/dispatch, "
+                  << ns / iterations / handlerCount << " ns/handler (" << counters[0] << ")\n";
+    }
+}
+
 int main() {
     // Create the delegator
     Printer printer;
@@ -83,11 +976,83 @@ int main() {
     printer.setPrintStrategy(filePrinter);
     printer.print("Hello, File!");
 
+    // Write to a real file without blocking the caller
+    auto asyncFile = std::make_shared<AsyncFilePrint>("printer.log");
+    printer.setPrintStrategy(asyncFile);
+    printer.print("Hello, Async File!");
+    asyncFile->flush();
+
+    // Benchmark: synchronous ofstream-per-call vs. batched background writer
+    printer.setPrintStrategy(std::make_shared<OfstreamFilePrint>("printer_sync.log"));
+    benchmarkFilePrint("ofstream per call", printer, 4, 25000);
+
+    auto batched = std::make_shared<AsyncFilePrint>("printer_async.log");
+    printer.setPrintStrategy(batched);
+    benchmarkFilePrint("async batched", printer, 4, 25000);
+    batched->flush();
+
+    // Stress: swapping the delegate while 32 threads are printing
+    benchmarkHotSwap(32, std::chrono::milliseconds(500));
+
+    // Inline delegates: strategies, lambdas and function pointers without allocating
+    PrintDelegate inlineDelegate = ConsolePrint{};
+    inlineDelegate("Hello, Inline Delegate!");
+    inlineDelegate = [](const std::string& text) { std::cout << "Lambda: " << text << std::endl; };
+    inlineDelegate("Hello, Lambda!");
+    ConsolePrint console;
+    printLines({"Hello, Callback!"}, console);
+    printLines({"Hello, Function!"}, printUpperCase);
+    printer.setPrintDelegate(printUpperCase);
+    printer.print("Hello, Printer!");
+    try {
+        PrintDelegate empty;
+        empty("Hello?");
+    } catch (const std::bad_function_call&) {
+        std::cout << "Empty delegate: nothing to call" << std::endl;
+    }
+
+    benchmarkDelegates(10'000'000);
+
+    // Multicast: one print fans out to console, file and a metrics counter
+    auto fanOut = std::make_shared<MulticastPrint<>>();
+    std::uint64_t printedBytes = 0;
+    fanOut->add(ConsolePrint{});
+    auto fileHandler = fanOut->add([asyncFile](const std::string& text) { asyncFile->print(text); });
+    fanOut->add([&printedBytes](const std::string& text) { printedBytes += text.size(); });
+    printer.setPrintStrategy(fanOut);
+    printer.print("Hello, Everyone!");
+    fanOut->remove(fileHandler);
+    printer.print("Hello, Console and Metrics!");
+    std::cout << "Metrics: " << printedBytes << " bytes printed\n";
+
+    benchmarkMulticast(1'000'000);
+
+    for (const char* log : {"printer.log", "printer_sync.log", "printer_async.log"}) {
+        std::remove(log);
+    }
+
     return 0;
 }
 
 //Printing to console: Hello, Console!
 //Saving to file: Hello, File!
+//ofstream per call: ... lines/sec, caller p50 ... us, p99 ... us
+//async batched: ... lines/sec, caller p50 ... us, p99 ... us
+//Hot swap: 32 threads, ... prints/sec, ... swaps
+//Printing to console: Hello, Inline Delegate!
+//Lambda: Hello, Lambda!
+//Printing to console: Hello, Callback!
+//Upper case: HELLO, FUNCTION!
+//Upper case: HELLO, PRINTER!
+//Empty delegate: nothing to call
+//Construct+call ns: shared_ptr ..., std::function ..., PrintDelegate ...
+//Call ns: shared_ptr ..., std::function ..., PrintDelegate ..., PrintCallbackRef ... (...)
+//Printing to console: Hello, Everyone!
+//Printing to console: Hello, Console and Metrics!
+//Metrics: 43 bytes printed
+//Multicast to 1 handlers: ... ns/dispatch, ... ns/handler (...)
+//Multicast to 8 handlers: ... ns/dispatch, ... ns/handler (...)
+//Multicast to 64 handlers: ... ns/dispatch, ... ns/handler (...)
 
 //Key Benefits of the Delegate Pattern
 //Decoupling:
@@ -27,10 +27,33 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <streambuf>
+#include <cstdint>
+
+// Simulates how long a device takes to power up
+using WarmUp = std::chrono::milliseconds;
 
 class DVDPlayer {
+private:
+    WarmUp warmUp;
+
 public:
+    explicit DVDPlayer(WarmUp warmUp = WarmUp{0}) : warmUp(warmUp) {}
+
     void on() {
+        std::this_thread::sleep_for(warmUp);
         std::cout << "DVD Player is ON.\n";
     }
 
@@ -44,8 +67,14 @@ public:
 };
 
 class SoundSystem {
+private:
+    WarmUp warmUp;
+
 public:
+    explicit SoundSystem(WarmUp warmUp = WarmUp{0}) : warmUp(warmUp) {}
+
     void on() {
+        std::this_thread::sleep_for(warmUp);
         std::cout << "Sound System is ON.\n";
     }
 
@@ -59,8 +88,14 @@ public:
 };
 
 class Projector {
+private:
+    WarmUp warmUp;
+
 public:
+    explicit Projector(WarmUp warmUp = WarmUp{0}) : warmUp(warmUp) {}
+
     void on() {
+        std::this_thread::sleep_for(warmUp);
         std::cout << "Projector is ON.\n";
     }
 
@@ -73,35 +108,683 @@ public:
     }
 };
 
+// Small fixed-size thread pool for running facade steps
+class StepExecutor {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+
+public:
+    explicit StepExecutor(std::size_t threads = 4) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        available.wait(lock, [this] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    StepExecutor(const StepExecutor&) = delete;
+    StepExecutor& operator=(const StepExecutor&) = delete;
+
+    ~StepExecutor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        available.notify_one();
+    }
+};
+
+struct StepTiming {
+    std::string name;
+    double startMs = 0.0; // Relative to the start of the run
+    double endMs = 0.0;
+    bool ran = false;     // False if skipped because a dependency failed
+};
+
+// Dependency DAG of facade steps. Steps may only depend on steps added before them, so
+// the graph can never contain a cycle. Independent steps run concurrently on an
+// executor, so the total time approaches the critical path instead of the sum.
+class StepGraph {
+private:
+    struct Step {
+        std::string name;
+        std::function<void()> action;
+        std::vector<std::size_t> dependents;
+        std::size_t dependencyCount = 0;
+    };
+
+    std::vector<Step> steps;
+
+public:
+    std::size_t add(std::string name, std::function<void()> action, std::vector<std::size_t> dependsOn = {}) {
+        std::size_t index = steps.size();
+        for (std::size_t dependency : dependsOn) {
+            if (dependency >= index) {
+                throw std::invalid_argument("Step " + name + " depends on a step that is not added yet");
+            }
+            steps[dependency].dependents.push_back(index);
+        }
+        steps.push_back(Step{std::move(name), std::move(action), {}, dependsOn.size()});
+        return index;
+    }
+
+    // Runs every step, inline in declaration order when executor is null. Rethrows the
+    // first step failure after the run; steps depending on a failed step are skipped.
+    std::vector<StepTiming> run(StepExecutor* executor) const {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        auto msSinceStart = [&] {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        };
+
+        std::vector<StepTiming> timings(steps.size());
+        std::exception_ptr failure;
+        std::vector<bool> blocked(steps.size(), false);
+
+        auto runStep = [&](std::size_t index) {
+            timings[index].name = steps[index].name;
+            if (blocked[index]) {
+                return false;
+            }
+            timings[index].startMs = msSinceStart();
+            try {
+                steps[index].action();
+                timings[index].ran = true;
+            } catch (...) {
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+            timings[index].endMs = msSinceStart();
+            return timings[index].ran;
+        };
+
+        if (!executor) {
+            for (std::size_t i = 0; i < steps.size(); ++i) {
+                if (!runStep(i)) {
+                    for (std::size_t dependent : steps[i].dependents) {
+                        blocked[dependent] = true;
+                    }
+                }
+            }
+        } else {
+            std::mutex mutex; // Guards blocked, failure and the completion count
+            std::condition_variable finished;
+            std::size_t completed = 0;
+            auto remaining = std::make_unique<std::atomic<std::size_t>[]>(steps.size());
+            for (std::size_t i = 0; i < steps.size(); ++i) {
+                remaining[i] = steps[i].dependencyCount;
+            }
+
+            std::function<void(std::size_t)> schedule = [&](std::size_t index) {
+                executor->submit([&, index] {
+                    bool skip;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        skip = blocked[index];
+                    }
+                    bool ok = false;
+                    if (skip) {
+                        timings[index].name = steps[index].name;
+                    } else {
+                        StepTiming timing;
+                        timing.name = steps[index].name;
+                        timing.startMs = msSinceStart();
+                        try {
+                            steps[index].action();
+                            timing.ran = ok = true;
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (!failure) {
+                                failure = std::current_exception();
+                            }
+                        }
+                        timing.endMs = msSinceStart();
+                        timings[index] = timing;
+                    }
+                    for (std::size_t dependent : steps[index].dependents) {
+                        if (!ok) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            blocked[dependent] = true;
+                        }
+                        if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                            schedule(dependent);
+                        }
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (++completed == steps.size()) {
+                        finished.notify_all();
+                    }
+                });
+            };
+
+            for (std::size_t i = 0; i < steps.size(); ++i) {
+                if (steps[i].dependencyCount == 0) {
+                    schedule(i);
+                }
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return completed == steps.size(); });
+        }
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        return timings;
+    }
+};
+
+// Subsystem Operations
+// Every subsystem call the facade makes, as data: an opcode plus its argument. The
+// facade performs its steps through this table, so the same calls can be recorded
+// once and replayed later without going through the facade.
+struct TheaterTarget {
+    DVDPlayer* dvdPlayer;
+    SoundSystem* soundSystem;
+    Projector* projector;
+};
+
+enum class TheaterOp : std::uint8_t {
+    ProjectorOn,
+    ProjectorInput,
+    ProjectorOff,
+    SoundOn,
+    SetVolume,
+    SoundOff,
+    DvdOn,
+    Play,
+    DvdOff,
+};
+
+using TheaterOpFn = void (*)(const TheaterTarget& target, const std::string& text, int number);
+
+inline constexpr TheaterOpFn kTheaterOps[] = {
+    [](const TheaterTarget& t, const std::string&, int) { t.projector->on(); },
+    [](const TheaterTarget& t, const std::string& source, int) { t.projector->setInput(source); },
+    [](const TheaterTarget& t, const std::string&, int) { t.projector->off(); },
+    [](const TheaterTarget& t, const std::string&, int) { t.soundSystem->on(); },
+    [](const TheaterTarget& t, const std::string&, int level) { t.soundSystem->setVolume(level); },
+    [](const TheaterTarget& t, const std::string&, int) { t.soundSystem->off(); },
+    [](const TheaterTarget& t, const std::string&, int) { t.dvdPlayer->on(); },
+    [](const TheaterTarget& t, const std::string& movie, int) { t.dvdPlayer->play(movie); },
+    [](const TheaterTarget& t, const std::string&, int) { t.dvdPlayer->off(); },
+};
+
+static_assert(sizeof(kTheaterOps) / sizeof(kTheaterOps[0]) == static_cast<std::size_t>(TheaterOp::DvdOff) + 1,
+              "kTheaterOps must have one entry per TheaterOp, in declaration order");
+
+// A compiled scenario: a flat array of pre-resolved operations whose string arguments
+// were interned once at compile time. Replaying is a single loop of indirect calls.
+class CompiledScenario {
+private:
+    struct BoundOp {
+        TheaterOpFn fn;
+        const std::string* text;
+        int number;
+    };
+
+    std::vector<std::string> strings; // Owned, never resized after compile
+    std::vector<BoundOp> ops;
+
+    friend class TheaterScenario;
+
+public:
+    CompiledScenario() = default;
+    CompiledScenario(CompiledScenario&&) = default;
+    CompiledScenario& operator=(CompiledScenario&&) = default;
+    CompiledScenario(const CompiledScenario&) = delete; // ops point into strings
+    CompiledScenario& operator=(const CompiledScenario&) = delete;
+
+    std::size_t size() const {
+        return ops.size();
+    }
+
+    void replay(const TheaterTarget& target) const {
+        for (const BoundOp& op : ops) {
+            op.fn(target, *op.text, op.number);
+        }
+    }
+
+    // Replays on many facades, one operation at a time across all of them
+    void replayBatch(const std::vector<TheaterTarget>& targets) const {
+        for (const BoundOp& op : ops) {
+            for (const TheaterTarget& target : targets) {
+                op.fn(target, *op.text, op.number);
+            }
+        }
+    }
+};
+
+// A recorded scenario: the subsystem calls a facade made, in order
+class TheaterScenario {
+private:
+    struct RecordedOp {
+        TheaterOp op;
+        std::size_t text; // Index into strings
+        int number;
+    };
+
+    std::mutex mutex; // Steps may be recorded from executor threads
+    std::vector<std::string> strings{std::string()};
+    std::vector<RecordedOp> recorded;
+
+    std::size_t intern(const std::string& text) {
+        for (std::size_t i = 0; i < strings.size(); ++i) {
+            if (strings[i] == text) {
+                return i;
+            }
+        }
+        strings.push_back(text);
+        return strings.size() - 1;
+    }
+
+public:
+    void record(TheaterOp op, const std::string& text, int number) {
+        std::lock_guard<std::mutex> lock(mutex);
+        recorded.push_back(RecordedOp{op, intern(text), number});
+    }
+
+    CompiledScenario compile() {
+        std::lock_guard<std::mutex> lock(mutex);
+        CompiledScenario plan;
+        plan.strings = strings;
+        plan.ops.reserve(recorded.size());
+        for (const RecordedOp& op : recorded) {
+            plan.ops.push_back({kTheaterOps[static_cast<std::size_t>(op.op)], &plan.strings[op.text], op.number});
+        }
+        return plan;
+    }
+};
+
 class HomeTheaterFacade {
 private:
     DVDPlayer* dvdPlayer;
     SoundSystem* soundSystem;
     Projector* projector;
+    StepExecutor* executor; // Null runs every step in order on the caller's thread
+
+    std::string movie;
+    StepGraph startup;
+    StepGraph shutdown;
+    std::vector<StepTiming> timings;
+    TheaterScenario* recording = nullptr;
+
+    void perform(TheaterOp op, const std::string& text = {}, int number = 0) {
+        if (recording) {
+            recording->record(op, text, number);
+        }
+        kTheaterOps[static_cast<std::size_t>(op)](target(), text, number);
+    }
+
+    void declareSteps() {
+        auto projectorOn = startup.add("projector on", [this] { perform(TheaterOp::ProjectorOn); });
+        auto projectorInput = startup.add("projector input", [this] { perform(TheaterOp::ProjectorInput, "DVD"); }, {projectorOn});
+        auto soundOn = startup.add("sound on", [this] { perform(TheaterOp::SoundOn); });
+        auto volume = startup.add("set volume", [this] { perform(TheaterOp::SetVolume, {}, 20); }, {soundOn});
+        auto dvdOn = startup.add("dvd on", [this] { perform(TheaterOp::DvdOn); });
+        startup.add("play", [this] { perform(TheaterOp::Play, movie); }, {projectorInput, volume, dvdOn});
+
+        shutdown.add("dvd off", [this] { perform(TheaterOp::DvdOff); });
+        shutdown.add("sound off", [this] { perform(TheaterOp::SoundOff); });
+        shutdown.add("projector off", [this] { perform(TheaterOp::ProjectorOff); });
+    }
 
 public:
-    HomeTheaterFacade(DVDPlayer* dvd, SoundSystem* sound, Projector* proj)
-        : dvdPlayer(dvd), soundSystem(sound), projector(proj) {}
+    HomeTheaterFacade(DVDPlayer* dvd, SoundSystem* sound, Projector* proj, StepExecutor* executor = nullptr)
+        : dvdPlayer(dvd), soundSystem(sound), projector(proj), executor(executor) {
+        declareSteps();
+    }
+
+    // The declared steps capture `this`, so a copied or moved facade would drive the original
+    HomeTheaterFacade(const HomeTheaterFacade&) = delete;
+    HomeTheaterFacade& operator=(const HomeTheaterFacade&) = delete;
+    HomeTheaterFacade(HomeTheaterFacade&&) = delete;
+    HomeTheaterFacade& operator=(HomeTheaterFacade&&) = delete;
+
+    TheaterTarget target() const {
+        return TheaterTarget{dvdPlayer, soundSystem, projector};
+    }
+
+    // Subsystem calls made while recording are appended to the scenario
+    void startRecording(TheaterScenario* scenario) {
+        recording = scenario;
+    }
+
+    void stopRecording() {
+        recording = nullptr;
+    }
 
     void watchMovie(const std::string& movie) {
         std::cout << "Preparing to watch movie: " << movie << "\n";
-        projector->on();
-        projector->setInput("DVD");
-        soundSystem->on();
-        soundSystem->setVolume(20);
-        dvdPlayer->on();
-        dvdPlayer->play(movie);
+        this->movie = movie;
+        timings = startup.run(executor);
         std::cout << "Enjoy your movie!\n";
     }
 
     void endMovie() {
         std::cout << "Shutting down the home theater.\n";
-        dvdPlayer->off();
-        soundSystem->off();
-        projector->off();
+        timings = shutdown.run(executor);
     }
+
+    // Per-step timings of the last watchMovie or endMovie
+    const std::vector<StepTiming>& lastTimings() const {
+        return timings;
+    }
+};
+
+// Lazy, Warm-Standby Subsystems
+// Owns one subsystem that is only constructed on first use. After a movie it is left
+// powered in standby, so the next movie skips the warm-up; once idle for longer than
+// the policy timeout it is switched off and destroyed to free its memory. Reaping is
+// call-driven, nothing runs in the background: watchMovie and endMovie reap what has
+// timed out, and an idle host schedules reapIdle() at nextReapAt() from its own timer
+// or event loop. Memory figures are simulated, from each subsystem's configured
+// working set.
+using TheaterClock = std::chrono::steady_clock;
+
+struct StandbyPolicy {
+    std::chrono::minutes idleTimeout{30};
 };
 
+template <typename Subsystem>
+class ManagedSubsystem {
+private:
+    std::function<std::unique_ptr<Subsystem>()> factory;
+    std::size_t workingSetBytes;  // Simulated driver/firmware memory held while alive
+    std::unique_ptr<Subsystem> instance;
+    std::vector<char> workingSet;
+    bool powered = false;
+    TheaterClock::time_point lastUsed{};
+
+public:
+    std::size_t coldStarts = 0;
+    std::size_t teardowns = 0;
+
+    ManagedSubsystem(std::function<std::unique_ptr<Subsystem>()> factory, std::size_t workingSetBytes)
+        : factory(std::move(factory)), workingSetBytes(workingSetBytes) {}
+
+    // Constructs and powers the subsystem if needed
+    Subsystem& use(TheaterClock::time_point now) {
+        if (!instance) {
+            instance = factory();
+            workingSet.assign(workingSetBytes, 1); // Touch it so it is really resident
+            ++coldStarts;
+        }
+        if (!powered) {
+            instance->on();
+            powered = true;
+        }
+        lastUsed = now;
+        return *instance;
+    }
+
+    void standby(TheaterClock::time_point now) {
+        lastUsed = now;
+    }
+
+    void reapIfIdle(TheaterClock::time_point now, const StandbyPolicy& policy) {
+        if (instance && now - lastUsed >= policy.idleTimeout) {
+            if (powered) {
+                instance->off();
+            }
+            instance.reset();
+            std::vector<char>().swap(workingSet);
+            powered = false;
+            ++teardowns;
+        }
+    }
+
+    // When reapIfIdle will next tear this subsystem down; time_point::max() if never
+    TheaterClock::time_point reapDeadline(const StandbyPolicy& policy) const {
+        return instance ? lastUsed + policy.idleTimeout : TheaterClock::time_point::max();
+    }
+
+    // Simulated: the object plus the working set it was configured with, not measured
+    std::size_t residentBytes() const {
+        return instance ? sizeof(Subsystem) + workingSet.capacity() : 0;
+    }
+};
+
+class LazyHomeTheaterFacade {
+private:
+    ManagedSubsystem<DVDPlayer> dvdPlayer;
+    ManagedSubsystem<SoundSystem> soundSystem;
+    ManagedSubsystem<Projector> projector;
+    StandbyPolicy policy;
+    std::function<TheaterClock::time_point()> now; // Injectable for trace replay
+
+public:
+    LazyHomeTheaterFacade(ManagedSubsystem<DVDPlayer> dvd, ManagedSubsystem<SoundSystem> sound,
+                          ManagedSubsystem<Projector> proj, StandbyPolicy policy = {},
+                          std::function<TheaterClock::time_point()> now = TheaterClock::now)
+        : dvdPlayer(std::move(dvd)), soundSystem(std::move(sound)), projector(std::move(proj)),
+          policy(policy), now(std::move(now)) {}
+
+    void watchMovie(const std::string& movie) {
+        std::cout << "Preparing to watch movie: " << movie << "\n";
+        auto time = now();
+        reapIdle(time);
+        projector.use(time).setInput("DVD");
+        soundSystem.use(time).setVolume(20);
+        dvdPlayer.use(time).play(movie);
+        std::cout << "Enjoy your movie!\n";
+    }
+
+    void endMovie() {
+        std::cout << "Putting the home theater on standby.\n";
+        auto time = now();
+        dvdPlayer.standby(time);
+        soundSystem.standby(time);
+        projector.standby(time);
+        reapIdle(time);
+    }
+
+    // Tears down subsystems idle past the timeout; an idle host calls this at nextReapAt()
+    void reapIdle(TheaterClock::time_point time) {
+        dvdPlayer.reapIfIdle(time, policy);
+        soundSystem.reapIfIdle(time, policy);
+        projector.reapIfIdle(time, policy);
+    }
+
+    // Earliest time a subsystem is due for teardown; time_point::max() if none is alive
+    TheaterClock::time_point nextReapAt() const {
+        return std::min({dvdPlayer.reapDeadline(policy), soundSystem.reapDeadline(policy),
+                         projector.reapDeadline(policy)});
+    }
+
+    std::size_t residentBytes() const {
+        return dvdPlayer.residentBytes() + soundSystem.residentBytes() + projector.residentBytes();
+    }
+
+    std::size_t coldStarts() const {
+        return dvdPlayer.coldStarts + soundSystem.coldStarts + projector.coldStarts;
+    }
+
+    std::size_t teardowns() const {
+        return dvdPlayer.teardowns + soundSystem.teardowns + projector.teardowns;
+    }
+};
+
+// Silences std::cout for its lifetime (keeps benchmark output readable)
+class QuietOutput {
+private:
+    std::streambuf* saved;
+
+public:
+    QuietOutput() : saved(std::cout.rdbuf(nullptr)) {}
+    ~QuietOutput() {
+        std::cout.rdbuf(saved);
+        std::cout.clear();
+    }
+};
+
+// Replays a week of evening viewing (movie, short break, another movie, then a long
+// gap) with simulated time, comparing the eager facade to the lazy one.
+void benchmarkSessionTrace() {
+    using namespace std::chrono;
+    struct Event {
+        minutes at;
+        bool watch; // false = endMovie
+    };
+    std::vector<Event> trace;
+    for (int day = 0; day < 7; ++day) {
+        minutes evening = hours(24 * day + 19);
+        trace.push_back({evening, true});
+        trace.push_back({evening + minutes(110), false});
+        if (day % 2 == 0) { // Binge night: second movie after a short break
+            trace.push_back({evening + minutes(120), true});
+            trace.push_back({evening + minutes(230), false});
+        }
+    }
+
+    const WarmUp dvdWarmUp{20}, soundWarmUp{10}, projectorWarmUp{30};
+    auto simulated = TheaterClock::time_point{};
+    LazyHomeTheaterFacade lazy(
+        ManagedSubsystem<DVDPlayer>([=] { return std::make_unique<DVDPlayer>(dvdWarmUp); }, 8 << 20),
+        ManagedSubsystem<SoundSystem>([=] { return std::make_unique<SoundSystem>(soundWarmUp); }, 4 << 20),
+        ManagedSubsystem<Projector>([=] { return std::make_unique<Projector>(projectorWarmUp); }, 16 << 20),
+        StandbyPolicy{minutes(30)}, [&] { return simulated; });
+    DVDPlayer dvd(dvdWarmUp);
+    SoundSystem sound(soundWarmUp);
+    Projector projector(projectorWarmUp);
+    HomeTheaterFacade eager(&dvd, &sound, &projector);
+
+    double eagerMs = 0.0, coldMs = 0.0, warmMs = 0.0;
+    std::size_t watches = 0, coldWatches = 0, peakResident = 0;
+    {
+        QuietOutput quiet;
+        for (const auto& event : trace) {
+            simulated = TheaterClock::time_point{} + event.at;
+            auto start = steady_clock::now();
+            if (event.watch) {
+                eager.watchMovie("Trace");
+            } else {
+                eager.endMovie();
+            }
+            if (event.watch) {
+                eagerMs += duration<double, std::milli>(steady_clock::now() - start).count();
+            }
+
+            std::size_t coldBefore = lazy.coldStarts();
+            start = steady_clock::now();
+            if (event.watch) {
+                lazy.watchMovie("Trace");
+            } else {
+                lazy.endMovie();
+            }
+            double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+            peakResident = std::max(peakResident, lazy.residentBytes());
+            if (event.watch) {
+                ++watches;
+                if (lazy.coldStarts() != coldBefore) {
+                    coldMs += ms;
+                    ++coldWatches;
+                } else {
+                    warmMs += ms;
+                }
+            }
+        }
+        // After the last session the host's timer fires once the subsystems time out
+        lazy.reapIdle(lazy.nextReapAt());
+    }
+
+    std::size_t warmWatches = watches - coldWatches;
+    std::cout << "Trace: " << watches << " movies, eager avg " << eagerMs / watches << " ms, lazy cold avg "
+              << (coldWatches ? coldMs / coldWatches : 0.0) << " ms (" << coldWatches << "), lazy warm avg "
+              << (warmWatches ? warmMs / warmWatches : 0.0) << " ms (" << warmWatches << ")\n";
+    std::cout << "Lazy simulated resident peak " << (peakResident >> 20) << " MiB, idle "
+              << (lazy.residentBytes() >> 20) << " MiB, " << lazy.teardowns() << " teardowns\n";
+}
+
+// Benchmark: calling the facade vs. replaying a compiled scenario, alone and in a batch
+void benchmarkScenarioReplay(int replays) {
+    using namespace std::chrono;
+    DVDPlayer dvd;
+    SoundSystem sound;
+    Projector projector;
+    HomeTheaterFacade facade(&dvd, &sound, &projector);
+
+    TheaterScenario scenario;
+    {
+        QuietOutput quiet;
+        facade.startRecording(&scenario);
+        facade.watchMovie("Inception");
+        facade.endMovie();
+        facade.stopRecording();
+    }
+    CompiledScenario plan = scenario.compile();
+
+    const std::size_t facadeCount = 64;
+    std::vector<DVDPlayer> dvds(facadeCount);
+    std::vector<SoundSystem> sounds(facadeCount);
+    std::vector<Projector> projectors(facadeCount);
+    std::vector<TheaterTarget> targets;
+    for (std::size_t i = 0; i < facadeCount; ++i) {
+        targets.push_back(TheaterTarget{&dvds[i], &sounds[i], &projectors[i]});
+    }
+
+    double directSeconds, replaySeconds, batchSeconds;
+    {
+        QuietOutput quiet;
+        auto start = steady_clock::now();
+        for (int i = 0; i < replays; ++i) {
+            facade.watchMovie("Inception");
+            facade.endMovie();
+        }
+        directSeconds = duration<double>(steady_clock::now() - start).count();
+
+        start = steady_clock::now();
+        for (int i = 0; i < replays; ++i) {
+            plan.replay(facade.target());
+        }
+        replaySeconds = duration<double>(steady_clock::now() - start).count();
+
+        start = steady_clock::now();
+        for (int i = 0; i < replays / static_cast<int>(facadeCount); ++i) {
+            plan.replayBatch(targets);
+        }
+        batchSeconds = duration<double>(steady_clock::now() - start).count();
+    }
+    std::cout << "Scenario of " << plan.size() << " ops: direct " << replays / directSeconds
+              << " replays/sec, compiled " << replays / replaySeconds << " replays/sec, batch of "
+              << facadeCount << " " << replays / batchSeconds << " replays/sec\n";
+}
+
+double totalMs(const std::vector<StepTiming>& timings) {
+    double end = 0.0;
+    for (const auto& timing : timings) {
+        end = std::max(end, timing.endMs);
+    }
+    return end;
+}
+
 int main() {
     // Create subsystem components
     DVDPlayer dvd;
@@ -115,6 +798,50 @@ int main() {
     homeTheater.watchMovie("Inception");
     homeTheater.endMovie();
 
+    // Devices that take time to warm up: sequential startup pays the sum of the
+    // warm-ups, the parallel facade only the longest chain
+    DVDPlayer slowDvd(WarmUp{200});
+    SoundSystem slowSound(WarmUp{100});
+    Projector slowProjector(WarmUp{300});
+    StepExecutor executor(4);
+
+    HomeTheaterFacade sequential(&slowDvd, &slowSound, &slowProjector);
+    sequential.watchMovie("Interstellar");
+    std::cout << "Sequential startup took " << totalMs(sequential.lastTimings()) << " ms\n";
+
+    HomeTheaterFacade parallel(&slowDvd, &slowSound, &slowProjector, &executor);
+    parallel.watchMovie("Interstellar");
+    std::cout << "Parallel startup took " << totalMs(parallel.lastTimings()) << " ms\n";
+    for (const auto& timing : parallel.lastTimings()) {
+        std::cout << "  " << timing.name << ": " << timing.startMs << " - " << timing.endMs << " ms\n";
+    }
+    parallel.endMovie();
+    std::cout << "Parallel shutdown took " << totalMs(parallel.lastTimings()) << " ms\n";
+
+    // Lazy facade: subsystems are built on first use and kept warm between movies
+    LazyHomeTheaterFacade lazyTheater(
+        ManagedSubsystem<DVDPlayer>([] { return std::make_unique<DVDPlayer>(); }, 0),
+        ManagedSubsystem<SoundSystem>([] { return std::make_unique<SoundSystem>(); }, 0),
+        ManagedSubsystem<Projector>([] { return std::make_unique<Projector>(); }, 0));
+    lazyTheater.watchMovie("Tenet");
+    lazyTheater.endMovie();
+    lazyTheater.watchMovie("Dunkirk"); // Warm: no subsystem is switched on again
+    lazyTheater.endMovie();
+
+    benchmarkSessionTrace();
+
+    // Record a movie night once, then replay the compiled plan on the same devices
+    TheaterScenario movieNight;
+    homeTheater.startRecording(&movieNight);
+    homeTheater.watchMovie("Inception");
+    homeTheater.endMovie();
+    homeTheater.stopRecording();
+    CompiledScenario plan = movieNight.compile();
+    std::cout << "Replaying " << plan.size() << " recorded operations.\n";
+    plan.replay(homeTheater.target());
+
+    benchmarkScenarioReplay(200000);
+
     return 0;
 }
 
@@ -130,6 +857,43 @@ int main() {
 //DVD Player is OFF.
 //Sound System is OFF.
 //Projector is OFF.
+//...
+//Sequential startup took ~600 ms
+//...
+//Parallel startup took ~300 ms
+//  projector on: 0 - 300 ms
+//  ...
+//Preparing to watch movie: Tenet
+//Projector is ON.
+//Setting projector input to DVD.
+//Sound System is ON.
+//Setting volume to 20.
+//DVD Player is ON.
+//Playing movie: Tenet
+//Enjoy your movie!
+//Putting the home theater on standby.
+//Preparing to watch movie: Dunkirk
+//Setting projector input to DVD.
+//Setting volume to 20.
+//Playing movie: Dunkirk
+//Enjoy your movie!
+//Putting the home theater on standby.
+//Trace: 11 movies, eager avg ~60 ms, lazy cold avg ~75 ms (7), lazy warm avg ~0 ms (4)
+//Lazy simulated resident peak 28 MiB, idle 0 MiB, 21 teardowns
+//Preparing to watch movie: Inception
+//...
+//Projector is OFF.
+//Replaying 9 recorded operations.
+//Projector is ON.
+//Setting projector input to DVD.
+//Sound System is ON.
+//Setting volume to 20.
+//DVD Player is ON.
+//Playing movie: Inception
+//DVD Player is OFF.
+//Sound System is OFF.
+//Projector is OFF.
+//Scenario of 9 ops: direct ... replays/sec, compiled ... replays/sec, batch of 64 ... replays/sec
 
 
 //Key Features of the Facade Pattern
@@ -30,6 +30,41 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <streambuf>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <condition_variable>
+#include <span>
+#include <optional>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <system_error>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
 
 // Subject Interface
 class Image {
@@ -38,45 +73,1381 @@ public:
     virtual ~Image() = default;
 };
 
+// Image File Bytes
+// Read-only view of a file's contents. Files above a size threshold are memory-mapped,
+// so "loading" copies nothing and pages are faulted in by the kernel as they are read;
+// an access hint tells the kernel how to read ahead. Small files, or files that cannot
+// be mapped, fall back to one buffered read.
+enum class ImageAccess {
+    Normal,
+    Sequential, // Decoded front to back: aggressive read-ahead, drop pages behind
+    Random,     // Tiles or regions: no read-ahead
+    WillNeed    // Start reading the whole file in the background now
+};
+
+struct ImageFileOptions {
+    std::size_t mapThreshold = 64 * 1024; // Smaller files are cheaper to read than to map
+    ImageAccess access = ImageAccess::Sequential;
+    bool forceBuffered = false;
+};
+
+class ImageFile {
+private:
+    const std::byte* data = nullptr;
+    std::size_t length = 0;
+    void* mapping = nullptr;
+    std::vector<std::byte> buffer;
+
+    static int adviceFor(ImageAccess access) {
+        switch (access) {
+        case ImageAccess::Sequential: return MADV_SEQUENTIAL;
+        case ImageAccess::Random: return MADV_RANDOM;
+        case ImageAccess::WillNeed: return MADV_WILLNEED;
+        case ImageAccess::Normal: break;
+        }
+        return MADV_NORMAL;
+    }
+
+    void readAll(int fd, const std::string& path) {
+        buffer.resize(length);
+        std::size_t done = 0;
+        while (done < length) {
+            ssize_t n = ::pread(fd, buffer.data() + done, length - done, static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                int error = n < 0 ? errno : EIO;
+                throw std::system_error(error, std::generic_category(), "Cannot read " + path);
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        data = buffer.data();
+    }
+
+    void release() {
+        if (mapping) {
+            ::munmap(mapping, length);
+        }
+        mapping = nullptr;
+        data = nullptr;
+        length = 0;
+        buffer.clear();
+    }
+
+public:
+    ImageFile() = default;
+
+    ImageFile(ImageFile&& other) noexcept
+        : data(other.data), length(other.length), mapping(other.mapping), buffer(std::move(other.buffer)) {
+        if (!mapping) {
+            data = buffer.data();
+        }
+        other.data = nullptr;
+        other.length = 0;
+        other.mapping = nullptr;
+    }
+
+    ImageFile& operator=(ImageFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            length = other.length;
+            mapping = other.mapping;
+            buffer = std::move(other.buffer);
+            data = mapping ? other.data : buffer.data();
+            other.data = nullptr;
+            other.length = 0;
+            other.mapping = nullptr;
+        }
+        return *this;
+    }
+
+    ImageFile(const ImageFile&) = delete;
+    ImageFile& operator=(const ImageFile&) = delete;
+
+    ~ImageFile() {
+        release();
+    }
+
+    static ImageFile open(const std::string& path, const ImageFileOptions& options = {}) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+        }
+        ImageFile file;
+        try {
+            struct stat st {};
+            if (::fstat(fd, &st) != 0) {
+                throw std::system_error(errno, std::generic_category(), "Cannot stat " + path);
+            }
+            file.length = static_cast<std::size_t>(st.st_size);
+            bool map = !options.forceBuffered && file.length >= options.mapThreshold && file.length > 0;
+            if (map) {
+                void* mapped = ::mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    file.mapping = mapped;
+                    file.data = static_cast<const std::byte*>(mapped);
+                    ::madvise(mapped, file.length, adviceFor(options.access)); // Only a hint
+                }
+            }
+            if (!file.mapping) {
+                file.readAll(fd, path);
+            }
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd); // A mapping stays valid after the descriptor is closed
+        return file;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return {data, length};
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    bool isMapped() const {
+        return mapping != nullptr;
+    }
+};
+
 class RealImage : public Image {
 private:
     std::string fileName;
+    ImageFile data; // Empty for simulated loads
 
 public:
+    static inline std::atomic<std::size_t> loads{0}; // Loads performed, for diagnostics
+
     explicit RealImage(const std::string& file) : fileName(file) {
         loadFromDisk(fileName); // Simulate expensive operation
     }
 
+    // Loads the file's bytes for real: memory-mapped when large enough, read otherwise
+    RealImage(const std::string& file, const ImageFileOptions& options) : fileName(file) {
+        loadFromDisk(fileName, options);
+    }
+
     void display() override {
         std::cout << "Displaying image: " << fileName << "\n";
     }
 
+    // Read-only, zero-copy view of the image bytes (empty for simulated loads)
+    std::span<const std::byte> bytes() const {
+        return data.bytes();
+    }
+
+    // Memory held by this image
+    std::size_t byteSize() const {
+        return sizeof(*this) + fileName.capacity() + data.size();
+    }
+
 private:
     void loadFromDisk(const std::string& file) {
+        if (file.empty()) {
+            throw std::runtime_error("Cannot load an image without a file name");
+        }
         std::cout << "Loading image from disk: " << file << "\n";
+        loads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void loadFromDisk(const std::string& file, const ImageFileOptions& options) {
+        if (file.empty()) {
+            throw std::runtime_error("Cannot load an image without a file name");
+        }
+        data = ImageFile::open(file, options);
+        std::cout << (data.isMapped() ? "Mapping" : "Reading") << " image from disk: " << file
+                  << " (" << data.size() << " bytes)\n";
+        loads.fetch_add(1, std::memory_order_relaxed);
     }
 };
 
+// Virtual proxy that is safe to share between threads. Exactly one caller loads the
+// RealImage (single flight); concurrent callers wait on the same shared future and see
+// the same result or exception. A failed load is not cached, so a later call retries.
+// Once loaded, display() costs a single acquire load before delegating.
 class ProxyImage : public Image {
 private:
     std::string fileName;
-    RealImage* realImage; // Pointer to the real object
+    std::optional<ImageFileOptions> fileOptions; // Load the file's bytes; simulated if unset
+    std::atomic<RealImage*> realImage{nullptr};  // Pointer to the real object
+    std::mutex loadMutex;                        // Guards inFlight
+    std::shared_future<RealImage*> inFlight;     // Valid while a load is running
 
 public:
-    explicit ProxyImage(const std::string& file) : fileName(file), realImage(nullptr) {}
+    explicit ProxyImage(const std::string& file) : fileName(file) {}
+
+    ProxyImage(const std::string& file, const ImageFileOptions& options) : fileName(file), fileOptions(options) {}
+
+    ProxyImage(const ProxyImage&) = delete;
+    ProxyImage& operator=(const ProxyImage&) = delete;
+
+    // Returns a future for the real image, starting the load on this thread if needed
+    std::shared_future<RealImage*> load() {
+        std::promise<RealImage*> promise;
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            if (RealImage* loaded = realImage.load(std::memory_order_acquire)) {
+                promise.set_value(loaded);
+                return promise.get_future().share();
+            }
+            if (inFlight.valid()) {
+                return inFlight; // Someone else is loading; share their result
+            }
+            inFlight = promise.get_future().share();
+        }
+
+        std::shared_future<RealImage*> result = inFlight;
+        try {
+            auto* loaded = fileOptions ? new RealImage(fileName, *fileOptions)
+                                       : new RealImage(fileName); // Lazy initialization
+            realImage.store(loaded, std::memory_order_release);
+            promise.set_value(loaded);
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        std::lock_guard<std::mutex> lock(loadMutex);
+        inFlight = {};
+        return result;
+    }
 
     void display() override {
-        if (!realImage) {
-            realImage = new RealImage(fileName); // Lazy initialization
+        RealImage* loaded = realImage.load(std::memory_order_acquire);
+        if (!loaded) {
+            loaded = load().get(); // Rethrows the load failure to every waiter
         }
-        realImage->display();
+        loaded->display();
     }
 
     ~ProxyImage() {
-        delete realImage; // Clean up real object
+        delete realImage.load(std::memory_order_acquire); // Clean up real object
+    }
+};
+
+// Caching Proxy
+// Instead of each proxy keeping its RealImage forever, proxies share an ImageCache with
+// a byte budget. The index is split into shards, each with its own lock, eviction list
+// and slice of the budget, so threads touching different images rarely contend.
+// Concurrent misses on the same file share one load. An evicted image is simply loaded
+// again the next time a proxy displays it.
+enum class EvictionPolicy {
+    LRU,   // Evict the least recently used image
+    Clock  // Second-chance approximation of LRU; a hit only sets a bit
+};
+
+struct ImageCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t residentBytes = 0;
+    std::size_t prefetches = 0;     // Loads started by prefetch()
+    std::size_t prefetchesUsed = 0; // ...that a later get() asked for
+
+    double hitRate() const {
+        return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+
+    double prefetchAccuracy() const {
+        return prefetches ? static_cast<double>(prefetchesUsed) / prefetches : 0.0;
+    }
+
+    std::size_t wastedPrefetches() const {
+        return prefetches - prefetchesUsed;
+    }
+};
+
+class ImageCache {
+public:
+    using ImagePtr = std::shared_ptr<RealImage>;
+    using Sizer = std::function<std::size_t(const RealImage&, const std::string& file)>;
+    using Loader = std::function<ImagePtr(const std::string& file)>;
+
+private:
+    struct Entry {
+        ImagePtr image;
+        std::size_t bytes;
+        std::list<std::string>::iterator lruPosition; // LRU only
+        std::size_t clockSlot = 0;                    // Clock only
+        bool referenced = false;                      // Clock only
+        bool unusedPrefetch = false;                  // Prefetched and not asked for yet
+    };
+
+    struct Load {
+        std::shared_future<ImagePtr> result;
+        bool prefetch;
+        bool claimed; // A get() is waiting for this prefetch
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> index;
+        std::unordered_map<std::string, Load> loading;
+        std::list<std::string> lru;      // Most recent at the front
+        std::vector<std::string> clock;  // Ring of resident files
+        std::size_t hand = 0;
+        std::size_t residentBytes = 0;
+    };
+
+    EvictionPolicy policy;
+    std::size_t shardBudget;
+    Sizer sizer;
+    Loader loader;
+    std::vector<Shard> shards;
+    std::atomic<std::size_t> hits{0};
+    std::atomic<std::size_t> misses{0};
+    std::atomic<std::size_t> evictions{0};
+    std::atomic<std::size_t> prefetches{0};
+    std::atomic<std::size_t> prefetchesUsed{0};
+
+    Shard& shardFor(const std::string& file) {
+        return shards[std::hash<std::string>{}(file) % shards.size()];
+    }
+
+    void touch(Shard& shard, Entry& entry) {
+        if (entry.unusedPrefetch) {
+            entry.unusedPrefetch = false;
+            prefetchesUsed.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (policy == EvictionPolicy::LRU) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, entry.lruPosition);
+        } else {
+            entry.referenced = true;
+        }
+    }
+
+    void erase(Shard& shard, const std::string& file) {
+        auto it = shard.index.find(file);
+        shard.residentBytes -= it->second.bytes;
+        if (policy == EvictionPolicy::LRU) {
+            shard.lru.erase(it->second.lruPosition);
+        } else {
+            std::size_t slot = it->second.clockSlot;
+            if (slot != shard.clock.size() - 1) {
+                shard.clock[slot] = std::move(shard.clock.back());
+                shard.index.find(shard.clock[slot])->second.clockSlot = slot;
+            }
+            shard.clock.pop_back();
+            if (shard.hand >= shard.clock.size()) {
+                shard.hand = 0;
+            }
+        }
+        shard.index.erase(it);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const std::string& victim(Shard& shard) {
+        if (policy == EvictionPolicy::LRU) {
+            return shard.lru.back();
+        }
+        while (true) {
+            Entry& entry = shard.index.find(shard.clock[shard.hand])->second;
+            if (!entry.referenced) {
+                return shard.clock[shard.hand];
+            }
+            entry.referenced = false; // Second chance
+            shard.hand = (shard.hand + 1) % shard.clock.size();
+        }
+    }
+
+    void insert(Shard& shard, const std::string& file, const ImagePtr& image, std::size_t bytes, bool unusedPrefetch) {
+        // Make room first; an image larger than the whole shard is still cached alone
+        while (!shard.index.empty() && shard.residentBytes + bytes > shardBudget) {
+            std::string evicted = victim(shard);
+            erase(shard, evicted);
+        }
+        Entry entry{image, bytes, {}, 0, false, unusedPrefetch};
+        if (policy == EvictionPolicy::LRU) {
+            shard.lru.push_front(file);
+            entry.lruPosition = shard.lru.begin();
+        } else {
+            entry.clockSlot = shard.clock.size();
+            shard.clock.push_back(file);
+        }
+        shard.index.emplace(file, std::move(entry));
+        shard.residentBytes += bytes;
+    }
+
+    // Looks up or loads file. A prefetch neither counts as a hit or miss nor refreshes
+    // the recency of an image that is already resident. A get() that joined a prefetch
+    // which then failed retries the load itself.
+    ImagePtr fetch(const std::string& file, bool prefetch) {
+        Shard& shard = shardFor(file);
+        bool counted = false;
+        while (true) {
+            std::promise<ImagePtr> promise;
+            {
+                std::unique_lock<std::mutex> lock(shard.mutex);
+                auto it = shard.index.find(file);
+                if (it != shard.index.end()) {
+                    if (prefetch) {
+                        return it->second.image;
+                    }
+                    touch(shard, it->second);
+                    if (!counted) {
+                        hits.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return it->second.image;
+                }
+                auto pending = shard.loading.find(file);
+                if (prefetch && pending != shard.loading.end()) {
+                    return nullptr; // Already on its way
+                }
+                if (!prefetch && !counted) {
+                    misses.fetch_add(1, std::memory_order_relaxed);
+                    counted = true;
+                }
+                if (pending != shard.loading.end()) {
+                    pending->second.claimed = true;
+                    bool joinedPrefetch = pending->second.prefetch;
+                    std::shared_future<ImagePtr> shared = pending->second.result;
+                    lock.unlock();
+                    try {
+                        return shared.get(); // Another thread is loading it
+                    } catch (...) {
+                        if (!joinedPrefetch) {
+                            throw;
+                        }
+                    }
+                    continue; // The prefetch failed; load it ourselves
+                }
+                shard.loading.emplace(file, Load{promise.get_future().share(), prefetch, false});
+                if (prefetch) {
+                    prefetches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            ImagePtr image;
+            try {
+                image = loader ? loader(file) : std::make_shared<RealImage>(file);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.loading.erase(file);
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+            std::size_t bytes = sizer ? sizer(*image, file) : image->byteSize();
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto load = shard.loading.find(file);
+                bool claimed = load->second.claimed;
+                if (prefetch && claimed) {
+                    prefetchesUsed.fetch_add(1, std::memory_order_relaxed);
+                }
+                insert(shard, file, image, bytes, prefetch && !claimed);
+                shard.loading.erase(load);
+            }
+            promise.set_value(image);
+            return image;
+        }
+    }
+
+public:
+    // Loader that reads each image's file through ImageFile, so the cache budget
+    // covers the real bytes
+    static Loader fileLoader(ImageFileOptions options = {}) {
+        return [options](const std::string& file) { return std::make_shared<RealImage>(file, options); };
+    }
+
+    explicit ImageCache(std::size_t budgetBytes, EvictionPolicy policy = EvictionPolicy::LRU,
+                        std::size_t shardCount = 16, Sizer sizer = {}, Loader loader = {})
+        : policy(policy), shardBudget(budgetBytes / shardCount), sizer(std::move(sizer)),
+          loader(std::move(loader)), shards(shardCount) {}
+
+    // Returns the image, loading it on a miss. The returned pointer stays valid even if
+    // the cache evicts the image meanwhile.
+    ImagePtr get(const std::string& file) {
+        return fetch(file, false);
+    }
+
+    // Loads file into the cache ahead of need; no-op if resident or already loading
+    void prefetch(const std::string& file) {
+        fetch(file, true);
+    }
+
+    ImageCacheStats stats() {
+        ImageCacheStats result;
+        result.hits = hits.load();
+        result.misses = misses.load();
+        result.evictions = evictions.load();
+        result.prefetches = prefetches.load();
+        result.prefetchesUsed = prefetchesUsed.load();
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result.residentBytes += shard.residentBytes;
+        }
+        return result;
+    }
+};
+
+// Proxy that keeps no image of its own; every display goes through the shared cache
+class CachedProxyImage : public Image {
+private:
+    std::string fileName;
+    ImageCache* cache;
+
+public:
+    CachedProxyImage(const std::string& file, ImageCache* cache) : fileName(file), cache(cache) {}
+
+    void display() override {
+        cache->get(fileName)->display(); // Reloads transparently if it was evicted
+    }
+};
+
+// Prefetching
+// Loads images before they are displayed, on a small pool of background I/O threads
+// (which also caps how many loads run at once). It learns from the display order: two
+// neighbouring displays in the gallery start a prefetch of the next few images in that
+// direction. Callers can also hint explicitly with prefetch(first, last). Newer hints
+// replace queued older ones, since the user has moved on.
+class ImagePrefetcher {
+private:
+    ImageCache& cache;
+    std::vector<std::string> gallery; // Display order
+    std::size_t lookahead;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::size_t> queue;
+    std::size_t lastDisplayed = SIZE_MAX;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    // Replaces the queue with [first, last]; both must be valid gallery indices
+    void enqueue(std::size_t first, std::size_t last, bool forward) {
+        queue.clear();
+        for (std::size_t i = 0; first <= last && i <= last - first; ++i) {
+            queue.push_back(forward ? first + i : last - i);
+        }
+        wake.notify_all();
+    }
+
+public:
+    ImagePrefetcher(ImageCache& cache, std::vector<std::string> gallery, std::size_t ioThreads = 4,
+                    std::size_t lookahead = 8)
+        : cache(cache), gallery(std::move(gallery)), lookahead(lookahead) {
+        for (std::size_t i = 0; i < ioThreads; ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    std::size_t index;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                        if (stopping) {
+                            return;
+                        }
+                        index = queue.front();
+                        queue.pop_front();
+                    }
+                    try {
+                        this->cache.prefetch(this->gallery[index]);
+                    } catch (const std::exception&) {
+                        // A failed prefetch is retried by the display that needs it
+                    }
+                }
+            });
+        }
+    }
+
+    ImagePrefetcher(const ImagePrefetcher&) = delete;
+    ImagePrefetcher& operator=(const ImagePrefetcher&) = delete;
+
+    ~ImagePrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const {
+        return gallery.size();
+    }
+
+    const std::string& file(std::size_t index) const {
+        return gallery[index];
+    }
+
+    // Explicit hint: images [first, last] will be displayed soon
+    void prefetch(std::size_t first, std::size_t last) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first >= gallery.size()) {
+            return; // Also covers an empty gallery, where size() - 1 would wrap
+        }
+        enqueue(first, std::min(last, gallery.size() - 1), true);
+    }
+
+    // Learned hint: called on every display
+    void onDisplay(std::size_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastDisplayed != SIZE_MAX && index == lastDisplayed + 1 && index + 1 < gallery.size()) {
+            enqueue(index + 1, std::min(index + lookahead, gallery.size() - 1), true);
+        } else if (lastDisplayed != SIZE_MAX && index + 1 == lastDisplayed && index > 0) {
+            enqueue(index > lookahead ? index - lookahead : 0, index - 1, false);
+        }
+        lastDisplayed = index;
+    }
+};
+
+class PrefetchingProxyImage : public Image {
+private:
+    std::size_t index;
+    ImageCache* cache;
+    ImagePrefetcher* prefetcher;
+
+public:
+    PrefetchingProxyImage(std::size_t index, ImageCache* cache, ImagePrefetcher* prefetcher)
+        : index(index), cache(cache), prefetcher(prefetcher) {}
+
+    void display() override {
+        prefetcher->onDisplay(index);
+        cache->get(prefetcher->file(index))->display();
+    }
+};
+
+// Remote Proxy
+// RemoteImage stands in for an image that lives in a separate image-server process,
+// reached over a Unix domain socket. Each connection pipelines: callers get a future
+// right away and many requests can be outstanding at once, matched to replies by id.
+// A writer thread sends everything queued since its last write as one frame, so small
+// requests are batched, and a pool spreads callers over several connections.
+//
+// Wire format, native byte order (both ends are on the same host):
+//   frame    = u32 payloadLength, payload
+//   request  = u32 id, u16 nameLength, name
+//   reply    = u32 id, u8 status (0 = ok), u32 dataLength, data (error text if status != 0)
+constexpr std::uint32_t kMaxFrameBytes = 16 << 20;
+constexpr std::size_t kMaxImageNameBytes = UINT16_MAX; // Sent as a 16-bit length
+
+bool readFully(int fd, void* buffer, std::size_t length) {
+    auto* cursor = static_cast<char*>(buffer);
+    while (length > 0) {
+        ssize_t n = ::read(fd, cursor, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false; // Closed or failed
+        }
+        cursor += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* buffer, std::size_t length) {
+    const auto* cursor = static_cast<const char*>(buffer);
+    while (length > 0) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = ::send(fd, cursor, length, MSG_NOSIGNAL);
+#else
+        ssize_t n = ::send(fd, cursor, length, 0); // SO_NOSIGPIPE is set instead
+#endif
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        cursor += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool readFrame(int fd, std::string& payload) {
+    std::uint32_t length = 0;
+    if (!readFully(fd, &length, sizeof(length)) || length > kMaxFrameBytes) {
+        return false;
+    }
+    payload.resize(length);
+    return readFully(fd, payload.data(), length);
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool takeValue(const std::string& in, std::size_t& offset, T& value) {
+    if (in.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+void disableSigpipe([[maybe_unused]] int fd) {
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+// Local stand-in for the image server: answers each request with a small thumbnail.
+// It runs on threads here, but speaks only through the socket, so it could just as
+// well be a separate process.
+class ImageServer {
+private:
+    std::string path;
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1}; // Written by the destructor to stop the acceptor
+    std::thread acceptor;
+    std::mutex mutex;
+    std::vector<int> clients;
+    std::vector<std::thread> handlers;
+
+    static bool sendFrame(int fd, std::string& frame) {
+        auto payloadLength = static_cast<std::uint32_t>(frame.size() - sizeof(std::uint32_t));
+        std::memcpy(frame.data(), &payloadLength, sizeof(payloadLength));
+        return writeFully(fd, frame.data(), frame.size());
+    }
+
+    // Answers every request in one frame. Replies can outgrow their requests, so
+    // they go out in as many frames as it takes to keep each under kMaxFrameBytes.
+    static bool handle(int fd, const std::string& request, std::string& frame) {
+        frame.assign(sizeof(std::uint32_t), '\0');
+        std::size_t offset = 0;
+        while (offset < request.size()) {
+            std::uint32_t id = 0;
+            std::uint16_t nameLength = 0;
+            if (!takeValue(request, offset, id) || !takeValue(request, offset, nameLength) ||
+                request.size() - offset < nameLength) {
+                break; // Malformed tail; drop it
+            }
+            std::string name = request.substr(offset, nameLength);
+            offset += nameLength;
+
+            std::string data;
+            std::uint8_t status = 0;
+            if (name.empty()) {
+                status = 1;
+                data = "Cannot load an image without a file name";
+            } else {
+                data.assign(64, static_cast<char>(std::hash<std::string>{}(name)));
+            }
+            std::size_t entry = sizeof(id) + sizeof(status) + sizeof(std::uint32_t) + data.size();
+            if (frame.size() - sizeof(std::uint32_t) + entry > kMaxFrameBytes) {
+                if (!sendFrame(fd, frame)) {
+                    return false;
+                }
+                frame.assign(sizeof(std::uint32_t), '\0');
+            }
+            appendValue(frame, id);
+            appendValue(frame, status);
+            appendValue(frame, static_cast<std::uint32_t>(data.size()));
+            frame += data;
+        }
+        return sendFrame(fd, frame);
     }
+
+    void serve(int fd) {
+        std::string request;
+        std::string frame;
+        while (readFrame(fd, request) && handle(fd, request, frame)) {
+        }
+    }
+
+public:
+    explicit ImageServer(std::string socketPath) : path(std::move(socketPath)) {
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        sockaddr_un address = socketAddress(path);
+        ::unlink(path.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd, 64) != 0) {
+            int error = errno;
+            ::close(listenFd);
+            throw std::system_error(error, std::generic_category(), "Cannot listen on " + path);
+        }
+        if (::pipe(wakePipe) != 0) {
+            int error = errno;
+            ::close(listenFd);
+            throw std::system_error(error, std::generic_category(), "pipe");
+        }
+        // Waits in poll() rather than accept(): shutting down a listening socket does
+        // not wake a blocked accept() on every platform (macOS, for one), but a write
+        // to the pipe always ends the poll
+        acceptor = std::thread([this] {
+            while (true) {
+                pollfd ready[2] = {{listenFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+                if (::poll(ready, 2, -1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return;
+                }
+                if (ready[1].revents != 0) {
+                    return; // Server is shutting down
+                }
+                if ((ready[0].revents & POLLIN) == 0) {
+                    return; // Listening socket failed
+                }
+                int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd < 0) {
+                    continue; // EINTR, or the client gave up before we got to it
+                }
+                disableSigpipe(fd);
+                std::lock_guard<std::mutex> lock(mutex);
+                clients.push_back(fd);
+                handlers.emplace_back([this, fd] { serve(fd); });
+            }
+        });
+    }
+
+    ImageServer(const ImageServer&) = delete;
+    ImageServer& operator=(const ImageServer&) = delete;
+
+    ~ImageServer() {
+        char stop = 0;
+        while (::write(wakePipe[1], &stop, 1) < 0 && errno == EINTR) {
+        }
+        acceptor.join();
+        ::close(wakePipe[0]);
+        ::close(wakePipe[1]);
+        ::close(listenFd);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : clients) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& handler : handlers) {
+            handler.join();
+        }
+        for (int fd : clients) {
+            ::close(fd);
+        }
+        ::unlink(path.c_str());
+    }
+};
+
+struct ImageReply {
+    std::string data;
 };
 
+// One pipelined connection to the image server
+class ImageConnection {
+private:
+    struct Request {
+        std::uint32_t id;
+        std::string name;
+        std::promise<ImageReply> promise;
+    };
+
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Request> queued;
+    std::unordered_map<std::uint32_t, std::promise<ImageReply>> inFlight;
+    std::uint32_t nextId = 0;
+    bool closed = false;
+    std::atomic<std::size_t> outstandingCount{0};
+    std::atomic<std::size_t> framesSent{0};
+    std::atomic<std::size_t> requestsSent{0};
+    std::thread writer;
+    std::thread reader;
+
+    void failAll(const std::string& why) {
+        std::vector<Request> unsent;
+        std::unordered_map<std::uint32_t, std::promise<ImageReply>> unanswered;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            unsent.swap(queued);
+            unanswered.swap(inFlight);
+        }
+        auto error = std::make_exception_ptr(std::runtime_error(why));
+        for (auto& request : unsent) {
+            request.promise.set_exception(error);
+        }
+        for (auto& [id, promise] : unanswered) {
+            promise.set_exception(error);
+        }
+        outstandingCount -= unsent.size() + unanswered.size();
+        wake.notify_all();
+    }
+
+    void writeLoop() {
+        std::vector<Request> batch;
+        std::string frame;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return closed || !queued.empty(); });
+                if (closed) {
+                    return;
+                }
+                // Take as many requests as fit in one frame; the rest go in the next
+                std::size_t count = 0;
+                for (std::size_t bytes = 0; count < queued.size(); ++count) {
+                    std::size_t entry = sizeof(std::uint32_t) + sizeof(std::uint16_t) + queued[count].name.size();
+                    if (bytes + entry > kMaxFrameBytes) {
+                        break;
+                    }
+                    bytes += entry;
+                }
+                if (count == queued.size()) {
+                    batch.swap(queued);
+                } else {
+                    batch.assign(std::make_move_iterator(queued.begin()),
+                                 std::make_move_iterator(queued.begin() + static_cast<std::ptrdiff_t>(count)));
+                    queued.erase(queued.begin(), queued.begin() + static_cast<std::ptrdiff_t>(count));
+                }
+                for (auto& request : batch) {
+                    inFlight.emplace(request.id, std::move(request.promise));
+                }
+            }
+            frame.assign(sizeof(std::uint32_t), '\0');
+            for (const auto& request : batch) {
+                appendValue(frame, request.id);
+                appendValue(frame, static_cast<std::uint16_t>(request.name.size()));
+                frame += request.name;
+            }
+            auto payloadLength = static_cast<std::uint32_t>(frame.size() - sizeof(std::uint32_t));
+            std::memcpy(frame.data(), &payloadLength, sizeof(payloadLength));
+            if (!writeFully(fd, frame.data(), frame.size())) {
+                failAll("Image server connection lost while sending");
+                return;
+            }
+            framesSent.fetch_add(1, std::memory_order_relaxed);
+            requestsSent.fetch_add(batch.size(), std::memory_order_relaxed);
+            batch.clear();
+        }
+    }
+
+    void readLoop() {
+        std::string payload;
+        while (readFrame(fd, payload)) {
+            std::size_t offset = 0;
+            while (offset < payload.size()) {
+                std::uint32_t id = 0, length = 0;
+                std::uint8_t status = 0;
+                if (!takeValue(payload, offset, id) || !takeValue(payload, offset, status) ||
+                    !takeValue(payload, offset, length) || payload.size() - offset < length) {
+                    failAll("Malformed reply from image server");
+                    return;
+                }
+                std::string data = payload.substr(offset, length);
+                offset += length;
+
+                std::promise<ImageReply> promise;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = inFlight.find(id);
+                    if (it == inFlight.end()) {
+                        continue; // Already failed locally
+                    }
+                    promise = std::move(it->second);
+                    inFlight.erase(it);
+                }
+                outstandingCount.fetch_sub(1, std::memory_order_relaxed);
+                if (status == 0) {
+                    promise.set_value(ImageReply{std::move(data)});
+                } else {
+                    promise.set_exception(std::make_exception_ptr(std::runtime_error(data)));
+                }
+            }
+        }
+        failAll("Image server connection closed");
+    }
+
+public:
+    explicit ImageConnection(const std::string& socketPath) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        sockaddr_un address = socketAddress(socketPath);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Cannot connect to " + socketPath);
+        }
+        disableSigpipe(fd);
+        writer = std::thread([this] { writeLoop(); });
+        reader = std::thread([this] { readLoop(); });
+    }
+
+    ImageConnection(const ImageConnection&) = delete;
+    ImageConnection& operator=(const ImageConnection&) = delete;
+
+    ~ImageConnection() {
+        ::shutdown(fd, SHUT_RDWR); // Unblocks the reader, which fails anything outstanding
+        reader.join();
+        writer.join();
+        ::close(fd);
+    }
+
+    // Names longer than kMaxImageNameBytes are rejected here, before anything is queued
+    std::future<ImageReply> request(const std::string& name) {
+        if (name.size() > kMaxImageNameBytes) {
+            throw std::invalid_argument("Image name too long: " + std::to_string(name.size()) + " bytes");
+        }
+        std::future<ImageReply> reply;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                throw std::runtime_error("Image server connection is closed");
+            }
+            Request request{nextId++, name, {}};
+            reply = request.promise.get_future();
+            queued.push_back(std::move(request));
+            outstandingCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake.notify_one();
+        return reply;
+    }
+
+    std::size_t outstanding() const {
+        return outstandingCount.load(std::memory_order_relaxed);
+    }
+
+    // Average requests per frame so far
+    double batching() const {
+        std::size_t frames = framesSent.load();
+        return frames ? static_cast<double>(requestsSent.load()) / frames : 0.0;
+    }
+};
+
+// Spreads requests over several connections, picking the least busy one
+class ImageConnectionPool {
+private:
+    std::vector<std::unique_ptr<ImageConnection>> connections;
+
+public:
+    ImageConnectionPool(const std::string& socketPath, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            connections.push_back(std::make_unique<ImageConnection>(socketPath));
+        }
+    }
+
+    std::future<ImageReply> request(const std::string& name) {
+        ImageConnection* best = connections.front().get();
+        for (const auto& connection : connections) {
+            if (connection->outstanding() < best->outstanding()) {
+                best = connection.get();
+            }
+        }
+        return best->request(name);
+    }
+
+    double batching() const {
+        double total = 0.0;
+        for (const auto& connection : connections) {
+            total += connection->batching();
+        }
+        return total / connections.size();
+    }
+};
+
+class RemoteImage : public Image {
+private:
+    std::string fileName;
+    ImageConnectionPool* pool;
+
+public:
+    RemoteImage(const std::string& file, ImageConnectionPool* pool) : fileName(file), pool(pool) {}
+
+    // Starts fetching without waiting, so callers can pipeline many images
+    std::future<ImageReply> fetch() {
+        return pool->request(fileName);
+    }
+
+    void display() override {
+        ImageReply reply = fetch().get(); // Rethrows server-side errors
+        std::cout << "Displaying remote image: " << fileName << " (" << reply.data.size() << " bytes)\n";
+    }
+};
+
+// Discards everything written to it; safe to share between threads
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+};
+
+// Silences std::cout for its lifetime (keeps benchmark output readable)
+class QuietOutput {
+private:
+    NullBuffer sink;
+    std::streambuf* saved;
+
+public:
+    QuietOutput() : saved(std::cout.rdbuf(&sink)) {}
+    ~QuietOutput() {
+        std::cout.rdbuf(saved);
+    }
+};
+
+// Stress: many threads display the same proxies at once; each image must load once
+void benchmarkConcurrentProxies(int threadCount, std::size_t proxyCount, int rounds) {
+    std::vector<std::unique_ptr<ProxyImage>> proxies;
+    for (std::size_t i = 0; i < proxyCount; ++i) {
+        proxies.push_back(std::make_unique<ProxyImage>("image_" + std::to_string(i) + ".jpg"));
+    }
+    std::size_t loadsBefore = RealImage::loads.load();
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        QuietOutput quiet;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                for (int round = 0; round < rounds; ++round) {
+                    for (std::size_t i = 0; i < proxyCount; ++i) {
+                        proxies[(i + static_cast<std::size_t>(t) * 131) % proxyCount]->display();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double displays = static_cast<double>(threadCount) * rounds * proxyCount;
+    std::cout << threadCount << " threads x " << proxyCount << " proxies: " << displays / seconds
+              << " displays/sec, " << RealImage::loads.load() - loadsBefore << " loads\n";
+}
+
+// Replays the same access trace against LRU and CLOCK caches: Zipf-distributed
+// browsing with periodic sequential gallery scans, images of varying size, and a
+// budget of about a tenth of the whole collection.
+void benchmarkCachePolicies(std::size_t imageCount, std::size_t accesses, int threadCount) {
+    auto sizeOf = [](const std::string& file) {
+        return std::size_t{50'000} + std::hash<std::string>{}(file) % 2'000'000; // 50 KB - 2 MB
+    };
+    std::vector<std::string> files;
+    std::size_t totalBytes = 0;
+    for (std::size_t i = 0; i < imageCount; ++i) {
+        files.push_back("photo_" + std::to_string(i) + ".jpg");
+        totalBytes += sizeOf(files.back());
+    }
+
+    std::vector<double> cdf(imageCount);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < imageCount; ++i) {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<std::uint32_t> trace;
+    trace.reserve(accesses);
+    while (trace.size() < accesses) {
+        if (trace.size() % 100'000 == 0) {
+            std::size_t from = rng() % imageCount;
+            for (std::size_t i = 0; i < 2'000 && trace.size() < accesses; ++i) {
+                trace.push_back(static_cast<std::uint32_t>((from + i) % imageCount));
+            }
+        }
+        trace.push_back(static_cast<std::uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin()));
+    }
+
+    for (EvictionPolicy policy : {EvictionPolicy::LRU, EvictionPolicy::Clock}) {
+        ImageCache cache(totalBytes / 10, policy, 16,
+                         [&](const RealImage&, const std::string& file) { return sizeOf(file); });
+        std::vector<CachedProxyImage> proxies;
+        proxies.reserve(imageCount);
+        for (const auto& file : files) {
+            proxies.emplace_back(file, &cache);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            QuietOutput quiet;
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&, t] {
+                    for (std::size_t i = t; i < trace.size(); i += threadCount) {
+                        proxies[trace[i]].display();
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ImageCacheStats stats = cache.stats();
+        std::cout << (policy == EvictionPolicy::LRU ? "LRU" : "CLOCK") << ": hit rate " << stats.hitRate() * 100
+                  << "%, " << stats.evictions << " evictions, " << (stats.residentBytes >> 20) << " of "
+                  << (totalBytes / 10 >> 20) << " MiB resident, " << accesses / seconds << " displays/sec\n";
+    }
+}
+
+// Browsing session: scroll through runs of a gallery with a short dwell per image, then
+// jump elsewhere. Loads take 2 ms; compares lazy proxies with prefetching proxies.
+void benchmarkPrefetch(std::size_t galleryImages, std::size_t displays) {
+    using namespace std::chrono;
+    std::vector<std::string> gallery;
+    for (std::size_t i = 0; i < galleryImages; ++i) {
+        gallery.push_back("gallery_" + std::to_string(i) + ".jpg");
+    }
+    std::mt19937 rng(11);
+    std::vector<std::size_t> session;
+    while (session.size() < displays) {
+        std::size_t start = rng() % galleryImages;
+        bool forward = rng() % 4 != 0;
+        for (std::size_t i = 0; i < 40 && session.size() < displays; ++i) {
+            std::size_t index = forward ? start + i : start + galleryImages - i;
+            session.push_back(index % galleryImages);
+        }
+    }
+    auto slowLoader = [](const std::string& file) {
+        std::this_thread::sleep_for(milliseconds(2));
+        return std::make_shared<RealImage>(file);
+    };
+    auto percentile = [](std::vector<double> values, double p) {
+        std::sort(values.begin(), values.end());
+        return values[static_cast<std::size_t>(p * (values.size() - 1))];
+    };
+
+    for (bool prefetching : {false, true}) {
+        std::vector<double> latencies;
+        ImageCacheStats stats;
+        {
+            QuietOutput quiet; // Outlives the prefetcher, whose last loads may still print
+            ImageCache cache(256, EvictionPolicy::LRU, 4, [](const RealImage&, const std::string&) { return 1; }, slowLoader);
+            ImagePrefetcher prefetcher(cache, gallery, 4, 8);
+            for (std::size_t index : session) {
+                auto start = steady_clock::now();
+                if (prefetching) {
+                    PrefetchingProxyImage(index, &cache, &prefetcher).display();
+                } else {
+                    CachedProxyImage(gallery[index], &cache).display();
+                }
+                latencies.push_back(duration<double, std::micro>(steady_clock::now() - start).count());
+                std::this_thread::sleep_for(microseconds(500)); // Dwell on the image
+            }
+            stats = cache.stats();
+        }
+        std::cout << (prefetching ? "Prefetching" : "Lazy") << ": p50 " << percentile(latencies, 0.5)
+                  << " us, p99 " << percentile(latencies, 0.99) << " us, hit rate " << stats.hitRate() * 100
+                  << "%, prefetch accuracy " << stats.prefetchAccuracy() * 100 << "%, "
+                  << stats.wastedPrefetches() << " wasted loads\n";
+    }
+}
+
+// Resident set size of this process, in bytes
+std::size_t residentBytes() {
+#ifdef __APPLE__
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return info.resident_size;
+    }
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Benchmark: memory-mapped vs. buffered loads of files from 1 KB to 1 GB. Reports the
+// load time, the time to checksum every page, and the RSS growth both right after
+// loading and once every page has been read, when a mapping is fully faulted in.
+void benchmarkImageFiles() {
+    using namespace std::chrono;
+    for (std::size_t size : {std::size_t{1} << 10, std::size_t{1} << 20, std::size_t{64} << 20, std::size_t{1} << 30}) {
+        const std::string path = "bench_image_" + std::to_string(size) + ".bin";
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            std::vector<char> chunk(std::min(size, std::size_t{1} << 20));
+            for (std::size_t i = 0; i < chunk.size(); ++i) {
+                chunk[i] = static_cast<char>((i * 2654435761u) >> 24);
+            }
+            for (std::size_t written = 0; written < size; written += chunk.size()) {
+                out.write(chunk.data(), static_cast<std::streamsize>(std::min(chunk.size(), size - written)));
+            }
+        }
+        for (bool buffered : {false, true}) {
+            ImageFileOptions options;
+            options.mapThreshold = 0;
+            options.forceBuffered = buffered;
+            std::size_t rssBefore = residentBytes();
+            auto start = steady_clock::now();
+            ImageFile file = ImageFile::open(path, options);
+            double loadMs = duration<double, std::milli>(steady_clock::now() - start).count();
+            std::size_t rssLoaded = residentBytes();
+
+            start = steady_clock::now();
+            std::uint64_t checksum = 0;
+            auto bytes = file.bytes();
+            for (std::size_t i = 0; i < bytes.size(); i += 4096) {
+                checksum += static_cast<std::uint8_t>(bytes[i]);
+            }
+            double touchMs = duration<double, std::milli>(steady_clock::now() - start).count();
+            std::size_t rssTouched = residentBytes();
+            auto growth = [&](std::size_t rss) { return (rss - std::min(rssBefore, rss)) >> 10; };
+            std::cout << (size >> 10) << " KiB " << (buffered ? "vector" : "mmap  ") << ": load " << loadMs
+                      << " ms, touch " << touchMs << " ms (" << checksum << "), RSS +" << growth(rssLoaded)
+                      << " KiB loaded, +" << growth(rssTouched) << " KiB touched\n";
+        }
+        std::remove(path.c_str());
+    }
+}
+
+// Benchmark: requests/sec and latency with 1, 8 and 64 requests in flight per client
+void benchmarkRemoteProxy(const std::string& socketPath, int clientThreads, int requestsPerClient) {
+    using namespace std::chrono;
+    for (std::size_t depth : {1, 8, 64}) {
+        ImageConnectionPool pool(socketPath, 2);
+        std::vector<std::vector<double>> latencies(clientThreads);
+        auto start = steady_clock::now();
+        std::vector<std::thread> clients;
+        for (int c = 0; c < clientThreads; ++c) {
+            clients.emplace_back([&, c] {
+                RemoteImage image("remote_" + std::to_string(c) + ".jpg", &pool);
+                std::deque<std::pair<std::future<ImageReply>, steady_clock::time_point>> window;
+                for (int sent = 0, done = 0; done < requestsPerClient;) {
+                    while (window.size() < depth && sent < requestsPerClient) {
+                        window.emplace_back(image.fetch(), steady_clock::now());
+                        ++sent;
+                    }
+                    window.front().first.get();
+                    latencies[c].push_back(duration<double, std::micro>(steady_clock::now() - window.front().second).count());
+                    window.pop_front();
+                    ++done;
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        std::vector<double> all;
+        for (const auto& perClient : latencies) {
+            all.insert(all.end(), perClient.begin(), perClient.end());
+        }
+        std::sort(all.begin(), all.end());
+        std::cout << "Pipeline depth " << depth << ": " << all.size() / seconds << " requests/sec, p50 "
+                  << all[all.size() / 2] << " us, p99 " << all[all.size() * 99 / 100] << " us, "
+                  << pool.batching() << " requests/frame\n";
+    }
+}
+
 int main() {
     // Create a proxy for an image
     ProxyImage proxyImage("test_image.jpg");
@@ -86,6 +1457,69 @@ int main() {
     proxyImage.display(); // Load and display the image
     proxyImage.display(); // Image is already loaded; just display it
 
+    // A failed load is reported to every caller
+    ProxyImage missing("");
+    try {
+        missing.display();
+    } catch (const std::exception& e) {
+        std::cout << "Load failed: " << e.what() << "\n";
+    }
+
+    benchmarkConcurrentProxies(64, 10000, 10);
+
+    // Proxies sharing a cache that only has room for one image
+    ImageCache cache(1, EvictionPolicy::LRU, 1, [](const RealImage&, const std::string&) { return 1; });
+    CachedProxyImage first("first.jpg", &cache);
+    CachedProxyImage second("second.jpg", &cache);
+    first.display();
+    second.display(); // Evicts first.jpg
+    first.display();  // Reloaded transparently
+    ImageCacheStats stats = cache.stats();
+    std::cout << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.evictions << " evictions\n";
+
+    benchmarkCachePolicies(100'000, 1'000'000, 4);
+
+    benchmarkPrefetch(2000, 600);
+
+    // Load a real file: mapped, with a zero-copy view of its bytes
+    {
+        std::ofstream out("real_image.jpg", std::ios::binary | std::ios::trunc);
+        std::vector<char> pixels(256 * 1024, '\x7f');
+        out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+    }
+    RealImage realImage("real_image.jpg", ImageFileOptions{});
+    realImage.display();
+    std::cout << "First byte: " << static_cast<int>(realImage.bytes()[0]) << "\n";
+
+    // The same file behind the virtual and caching proxies
+    ProxyImage mappedProxy("real_image.jpg", ImageFileOptions{});
+    mappedProxy.display(); // Mapped on first display
+    ImageCache fileCache(1 << 20, EvictionPolicy::LRU, 1, {}, ImageCache::fileLoader());
+    CachedProxyImage cachedFile("real_image.jpg", &fileCache);
+    cachedFile.display();
+    cachedFile.display(); // Served from the cache
+    std::remove("real_image.jpg");
+
+    benchmarkImageFiles();
+
+    // Remote proxy talking to a local image server over a Unix domain socket
+    const std::string socketPath = "/tmp/imageserver-" + std::to_string(::getpid()) + ".sock";
+    {
+        ImageServer server(socketPath);
+        ImageConnectionPool pool(socketPath, 2);
+        RemoteImage remote("remote_image.jpg", &pool);
+        remote.display();
+        RemoteImage unnamed("", &pool);
+        try {
+            unnamed.display();
+        } catch (const std::exception& e) {
+            std::cout << "Remote load failed: " << e.what() << "\n";
+        }
+
+        benchmarkRemoteProxy(socketPath, 4, 50'000);
+    }
+
     return 0;
 }
 
@@ -93,13 +1527,44 @@ int main() {
 //Loading image from disk: test_image.jpg
 //Displaying image: test_image.jpg
 //Displaying image: test_image.jpg
+//Load failed: Cannot load an image without a file name
+//64 threads x 10000 proxies: ... displays/sec, 10000 loads
+//Loading image from disk: first.jpg
+//Displaying image: first.jpg
+//Loading image from disk: second.jpg
+//Displaying image: second.jpg
+//Loading image from disk: first.jpg
+//Displaying image: first.jpg
+//Cache: 0 hits, 3 misses, 2 evictions
+//LRU: hit rate ...%, ... evictions, ... of ... MiB resident, ... displays/sec
+//CLOCK: hit rate ...%, ... evictions, ... of ... MiB resident, ... displays/sec
+//Lazy: p50 ... us, p99 ... us, hit rate ...%, prefetch accuracy 0%, 0 wasted loads
+//Prefetching: p50 ... us, p99 ... us, hit rate ...%, prefetch accuracy ...%, ... wasted loads
+//Mapping image from disk: real_image.jpg (262144 bytes)
+//Displaying image: real_image.jpg
+//First byte: 127
+//Mapping image from disk: real_image.jpg (262144 bytes)
+//Displaying image: real_image.jpg
+//Mapping image from disk: real_image.jpg (262144 bytes)
+//Displaying image: real_image.jpg
+//Displaying image: real_image.jpg
+//1 KiB mmap  : load ... ms, touch ... ms (...), RSS +0 KiB loaded, +... KiB touched
+//1 KiB vector: load ... ms, touch ... ms (...), RSS +... KiB loaded, +... KiB touched
+//...
+//1048576 KiB mmap  : load ... ms, touch ... ms (...), RSS +0 KiB loaded, +1048576 KiB touched
+//1048576 KiB vector: load ... ms, touch ... ms (...), RSS +1048576 KiB loaded, +1048576 KiB touched
+//Displaying remote image: remote_image.jpg (64 bytes)
+//Remote load failed: Cannot load an image without a file name
+//Pipeline depth 1: ... requests/sec, p50 ... us, p99 ... us, ... requests/frame
+//Pipeline depth 8: ... requests/sec, p50 ... us, p99 ... us, ... requests/frame
+//Pipeline depth 64: ... requests/sec, p50 ... us, p99 ... us, ... requests/frame
 
 
 //Key Features of the Proxy Pattern
 //Encapsulation of Access:
 //Controls access to the real object while keeping the interface consistent.
 //Delayed Initialization:
-//Creates expensive objects only when they are needed (virtual proxy).
+//Creates expensive objects only when they are needed (virtual proxy). When the proxy is shared between threads, the lazy load must be single-flight so the object is created exactly once.
 //Additional Functionality:
 //Can add features like caching, logging, or security checks.
 //Real-World Applications
@@ -108,7 +1573,7 @@ int main() {
 //Protection Proxy:
 //Role-based access control systems where sensitive operations are restricted.
 //Remote Proxy:
-//Distributed systems, where the proxy represents objects on remote servers.
+//Distributed systems, where the proxy represents objects on remote servers. Round trips dominate, so pipeline requests and batch small ones into one frame rather than waiting for each reply.
 //Smart Proxy:
 //Adding logging, usage statistics, or monitoring functionality to objects.
 //Caveats